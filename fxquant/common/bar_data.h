@@ -1,14 +1,15 @@
 #pragma once
 #include <ctime>
+#include "fixed_point.h"
 
 namespace fx {
 
 struct bar_data
 {
-    double o;
-    double h;
-    double l;
-    double c;
+    price_type o;
+    price_type h;
+    price_type l;
+    price_type c;
     time_t t;
 };
 
@@ -0,0 +1,260 @@
+#include <ctime>
+#include <vector>
+#include <cstring>
+#include <fstream>
+#include <experimental/filesystem>
+#include "bar_store.h"
+
+namespace fs = std::experimental::filesystem;
+using namespace std::chrono;
+
+namespace {
+
+const char bar_file_magic[8] = { 'F', 'X', 'B', 'A', 'R', 'S', '\0', '\0' };
+
+int64_t to_ms(fx::timepoint_type t)
+{
+    return duration_cast<milliseconds>(t.time_since_epoch()).count();
+}
+
+std::string time_to_string(fx::timepoint_type tp)
+{
+    char str[32];
+    time_t t = system_clock::to_time_t(tp);
+    strftime(str, sizeof(str), "%Y-%m-%d-%H%M", gmtime(&t));
+    return str;
+}
+}
+
+namespace fx {
+
+STATIC_ASSERT(sizeof(bar_file::header) == 64);
+STATIC_ASSERT(sizeof(bar_file::section) == 16);
+
+// bar_file
+
+bar_file::bar_file() : header_(nullptr), sections_(nullptr), bars_(nullptr)
+{
+}
+
+bool bar_file::open(const std::string& path)
+{
+    close();
+
+    if (!file_.open(path))
+    {
+        return false;
+    }
+
+    const size_t size = file_.size();
+    auto hdr = reinterpret_cast<const header*>(file_.data());
+
+    if ((size >= sizeof(header)) &&
+        (memcmp(hdr->magic, bar_file_magic, sizeof(bar_file_magic)) == 0) &&
+        (hdr->version == current_version) &&
+        (size >= sizeof(header) + hdr->timeframe_count * sizeof(section)))
+    {
+        auto sections = reinterpret_cast<const section*>(file_.data() + sizeof(header));
+        uint64_t count = 0;
+
+        for (size_t i = 0; i < hdr->timeframe_count; ++i)
+        {
+            count += sections[i].count;
+        }
+
+        if (size == sizeof(header) + hdr->timeframe_count * sizeof(section) + count * sizeof(bar_data))
+        {
+            header_ = hdr;
+            sections_ = sections;
+            bars_ = reinterpret_cast<const bar_data*>(sections + hdr->timeframe_count);
+            return true;
+        }
+    }
+
+    DEBUG_TRACE("bar_file::open(): '%s' is not a valid bar file", path.c_str());
+    close();
+    return false;
+}
+
+void bar_file::close()
+{
+    file_.close();
+    header_ = nullptr;
+    sections_ = nullptr;
+    bars_ = nullptr;
+}
+
+timepoint_type bar_file::get_from() const
+{
+    return timepoint_type(milliseconds(header_->from));
+}
+
+timepoint_type bar_file::get_to() const
+{
+    return timepoint_type(milliseconds(header_->to));
+}
+
+const bar_data* bar_file::get_bars(timeframe_type tf, size_t& count) const
+{
+    const bar_data* p = bars_;
+
+    for (size_t i = 0; i < get_timeframe_count(); ++i)
+    {
+        if (sections_[i].minutes == tf.count())
+        {
+            count = static_cast<size_t>(sections_[i].count);
+            return (count > 0) ? p : nullptr;
+        }
+
+        p += sections_[i].count;
+    }
+
+    count = 0;
+    return nullptr;
+}
+
+bool bar_file::write(const std::string& path, symbol sym, timepoint_type from, timepoint_type to,
+    uint64_t source, time_t next_time, const bar_map_type& bars)
+{
+    header hdr;
+    memset(&hdr, 0, sizeof(hdr));
+    memcpy(hdr.magic, bar_file_magic, sizeof(hdr.magic));
+    hdr.version = current_version;
+    hdr.sym = static_cast<uint32_t>(sym);
+    hdr.from = to_ms(from);
+    hdr.to = to_ms(to);
+    hdr.source = source;
+    hdr.next_time = static_cast<int64_t>(next_time);
+    hdr.timeframe_count = static_cast<uint32_t>(bars.size());
+
+    std::vector<section> sections;
+
+    for (const auto& b : bars)
+    {
+        section s;
+        memset(&s, 0, sizeof(s));
+        s.minutes = static_cast<int32_t>(b.first.count());
+        s.count = b.second.size();
+        sections.push_back(s);
+    }
+
+    // write into a temporary file first, so a reader never maps a partial file
+    const std::string tmp_path = path + ".tmp";
+
+    { // scope
+        std::ofstream file(tmp_path, std::ios::binary | std::ios::trunc);
+
+        if (!file.is_open())
+        {
+            return false;
+        }
+
+        file.write(reinterpret_cast<const char*>(&hdr), sizeof(hdr));
+
+        if (!sections.empty())
+        {
+            file.write(reinterpret_cast<const char*>(sections.data()), sections.size() * sizeof(section));
+        }
+
+        for (const auto& b : bars)
+        {
+            if (!b.second.empty())
+            {
+                file.write(reinterpret_cast<const char*>(b.second.data()), b.second.size() * sizeof(bar_data));
+            }
+        }
+
+        if (!file.good())
+        {
+            file.close();
+            fs::remove(tmp_path);
+            return false;
+        }
+    }
+
+    try
+    {
+        fs::rename(tmp_path, path);
+        return true;
+    }
+    catch (const std::exception& x)
+    {
+        DEBUG_TRACE("bar_file::write(): %s", x.what());
+    }
+
+    return false;
+}
+
+// bar_store
+
+bar_store::bar_store(const std::string& dir) : dir_(dir)
+{
+}
+
+std::string bar_store::get_path(symbol sym, timepoint_type from, timepoint_type to) const
+{
+    fs::path path = fs::path(dir_) / symbol_to_string(sym) /
+        (time_to_string(from) + "_" + time_to_string(to) + ".bars");
+    return path.string();
+}
+
+bool bar_store::open(bar_file& file, symbol sym, timepoint_type from, timepoint_type to,
+    uint64_t source, const timeframe_type* timeframes, size_t timeframe_count) const
+{
+    if (!file.open(get_path(sym, from, to)))
+    {
+        return false;
+    }
+
+    bool valid = (file.get_symbol() == sym) && (file.get_from() == from) && (file.get_to() == to) &&
+        (file.get_source() == source) && (file.get_timeframe_count() == timeframe_count);
+
+    for (size_t i = 0; valid && (i < timeframe_count); ++i)
+    {
+        valid = (file.get_timeframe(i) == timeframes[i]);
+    }
+
+    if (!valid)
+    {
+        file.close();
+    }
+
+    return valid;
+}
+
+bool bar_store::write(symbol sym, timepoint_type from, timepoint_type to,
+    uint64_t source, time_t next_time, const bar_file::bar_map_type& bars) const
+{
+    const fs::path path = get_path(sym, from, to);
+
+    try
+    {
+        if (!fs::exists(path.parent_path()))
+        {
+            fs::create_directories(path.parent_path());
+        }
+    }
+    catch (const std::exception& x)
+    {
+        DEBUG_TRACE("bar_store::write(): %s", x.what());
+        return false;
+    }
+
+    return bar_file::write(path.string(), sym, from, to, source, next_time, bars);
+}
+
+uint64_t bar_store::source_id(const std::string& description)
+{
+    // FNV-1a
+    uint64_t h = 14695981039346656037ULL;
+
+    for (unsigned char c : description)
+    {
+        h ^= c;
+        h *= 1099511628211ULL;
+    }
+
+    return h;
+}
+
+} // namespace fx
@@ -0,0 +1,122 @@
+#pragma once
+#include <map>
+#include <string>
+#include "types.h"
+#include "debug.h"
+#include "symbol.h"
+#include "bar_data.h"
+#include "mapped_file.h"
+
+namespace fx {
+
+// A memory-mapped file with the bars of one symbol for a time range,
+// for all the time frames of a feeder.
+// Layout (native byte order):
+//   header
+//   section[timeframe_count] - the time frame and the number of its bars
+//   bar_data[]               - the bars of every time frame in the order of the sections
+class bar_file
+{
+public:
+    struct header
+    {
+        char magic[8];
+        uint32_t version;
+        uint32_t sym;
+        int64_t from;      // ms since epoch, inclusive
+        int64_t to;        // ms since epoch, exclusive
+        uint64_t source;   // the id of the tick source the bars are built from
+        int64_t next_time; // the open time of the bar after the last stored base bar
+        uint32_t timeframe_count;
+        uint8_t reserved[12];
+    };
+
+    struct section
+    {
+        int32_t minutes;
+        uint32_t reserved;
+        uint64_t count;
+    };
+
+    typedef std::map<timeframe_type, bar_array_type> bar_map_type;
+
+    static const uint32_t current_version = 1;
+
+public:
+    bar_file();
+
+    bool open(const std::string& path);
+    void close();
+
+    bool is_open() const
+    {
+        return header_ != nullptr;
+    }
+
+    symbol get_symbol() const
+    {
+        return static_cast<symbol>(header_->sym);
+    }
+
+    timepoint_type get_from() const;
+    timepoint_type get_to() const;
+
+    uint64_t get_source() const
+    {
+        return header_->source;
+    }
+
+    time_t get_next_time() const
+    {
+        return static_cast<time_t>(header_->next_time);
+    }
+
+    size_t get_timeframe_count() const
+    {
+        return header_->timeframe_count;
+    }
+
+    timeframe_type get_timeframe(size_t index) const
+    {
+        DEBUG_ASSERT(index < get_timeframe_count());
+        return timeframe_type(sections_[index].minutes);
+    }
+
+    // the bars of the time frame, nullptr if there are none
+    const bar_data* get_bars(timeframe_type tf, size_t& count) const;
+
+    // writes the bars of all the time frames into a new file
+    static bool write(const std::string& path, symbol sym, timepoint_type from, timepoint_type to,
+        uint64_t source, time_t next_time, const bar_map_type& bars);
+
+private:
+    mapped_file file_;
+    const header* header_;
+    const section* sections_;
+    const bar_data* bars_;
+};
+
+// a directory of bar files: <dir>/<symbol>/<from>_<to>.bars
+class bar_store
+{
+public:
+    explicit bar_store(const std::string& dir);
+
+    std::string get_path(symbol sym, timepoint_type from, timepoint_type to) const;
+
+    // opens the file of the range if it has been built from the same source
+    // with the same time frames, otherwise the bars must be built again
+    bool open(bar_file& file, symbol sym, timepoint_type from, timepoint_type to,
+        uint64_t source, const timeframe_type* timeframes, size_t timeframe_count) const;
+
+    bool write(symbol sym, timepoint_type from, timepoint_type to,
+        uint64_t source, time_t next_time, const bar_file::bar_map_type& bars) const;
+
+    // the id of a tick source described by a string, e.g. the source name
+    static uint64_t source_id(const std::string& description);
+
+private:
+    const std::string dir_;
+};
+
+} // namespace fx
@@ -1,28 +1,133 @@
 #pragma once
-#include <functional>
+#include <ctime>
+#include "common.h"
 #include "bar_data.h"
 #include "tick_data.h"
 
 namespace fx {
 
+// Builds the bars of a single time frame from ticks or from the closed bars
+// of a lower time frame. The caller computes the tick time once for all its
+// factories and dispatches the closed bars itself.
 class candle_factory
 {
 public:
-    typedef std::function<void(const bar_data&)> callback_func;
+    candle_factory();
+    explicit candle_factory(timeframe_type time_frame);
 
-public:
-    candle_factory(timeframe_type time_frame, callback_func on_bar);
-    void put_tick(const tick_data& tick);
+    // returns true if the tick has opened a new bar, the previous bar is copied to 'closed'
+    ALWAYS_INLINE bool put_tick(time_t t, price_type bid, bar_data& closed)
+    {
+        const time_t bar_time = t - t % divider_;
+
+        if (bar_time != bar_.t)
+        {
+            // new candle
+            const bool has_bar = (bar_.t > 0);
+
+            if (has_bar)
+            {
+                closed = bar_;
+            }
+
+            bar_.o = bid;
+            bar_.h = bid;
+            bar_.l = bid;
+            bar_.c = bid;
+            bar_.t = bar_time;
+            return has_bar;
+        }
+
+        bar_.c = bid;
+
+        if (bid > bar_.h)
+        {
+            bar_.h = bid;
+        }
+        else if (bid < bar_.l)
+        {
+            bar_.l = bid;
+        }
+
+        return false;
+    }
+
+    // puts a run of ticks which belong to one bar of this time frame at once,
+    // the same as put_tick() for each of them
+    ALWAYS_INLINE bool put_ticks(time_t t, price_type first, price_type high, price_type low,
+        price_type last, bar_data& closed)
+    {
+        const bool has_closed = put_tick(t, first, closed);
+
+        if (high > bar_.h)
+        {
+            bar_.h = high;
+        }
+
+        if (low < bar_.l)
+        {
+            bar_.l = low;
+        }
+
+        bar_.c = last;
+        return has_closed;
+    }
+
+    // merges a closed bar of a lower time frame, 'next_time' is the open time of the
+    // next lower bar; returns true if this bar is complete, it is copied to 'closed'
+    ALWAYS_INLINE bool put_bar(const bar_data& bar, time_t next_time, bar_data& closed)
+    {
+        const time_t bar_time = bar.t - bar.t % divider_;
+
+        if (bar_time != bar_.t)
+        {
+            bar_ = bar;
+            bar_.t = bar_time;
+        }
+        else
+        {
+            bar_.c = bar.c;
+
+            if (bar.h > bar_.h)
+            {
+                bar_.h = bar.h;
+            }
+
+            if (bar.l < bar_.l)
+            {
+                bar_.l = bar.l;
+            }
+        }
+
+        if (next_time - next_time % divider_ != bar_.t)
+        {
+            closed = bar_;
+            bar_.t = 0;
+            return true;
+        }
+
+        return false;
+    }
+
+    bool put_tick(const tick_data& tick, bar_data& closed)
+    {
+        return put_tick(std::chrono::system_clock::to_time_t(tick.get_time()), tick.get_bid_price(), closed);
+    }
 
     timeframe_type get_time_frame() const
     {
         return time_frame_;
     }
 
+    // the open time of the current bar, 0 if there is none
+    time_t get_bar_time() const
+    {
+        return bar_.t;
+    }
+
 private:
-    const timeframe_type time_frame_;
-    const unsigned int divider_;
-    callback_func on_bar_;
+    timeframe_type time_frame_;
+    time_t divider_;
     bar_data bar_;
 };
 
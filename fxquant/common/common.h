@@ -25,6 +25,9 @@ namespace constants
     const uint16_t uint16_max = UINT16_C(0xFFFF);
     const uint32_t uint32_max = UINT32_C(0xFFFFFFFF);
     const uint64_t uint64_max = UINT64_C(0xFFFFFFFFFFFFFFFF);
+
+    // used to keep the data written by different threads apart
+    const size_t cache_line_size = 64;
 } 
 
 #define ARRAY_SIZE(x) (sizeof(x) / sizeof(x[0]))
@@ -19,35 +19,20 @@ bool event::wait(std::chrono::milliseconds timeout)
 {
     std::unique_lock<std::mutex> lock(mutex_);
 
-    if (signaled_ == false)
+    // a steady clock, so changing the system time does not shorten or extend the wait
+    if (!cond_.wait_until(lock, std::chrono::steady_clock::now() + timeout, [this]() { return signaled_; }))
     {
-        auto t = std::chrono::system_clock::now() + timeout;
-
-        while (!signaled_)
-        {
-            if (cond_.wait_until(lock, t) == std::cv_status::timeout)
-            {
-                return false;
-            }
-        }
-    }
-    else
-    {
-        signaled_ = false;
+        return false;
     }
 
+    signaled_ = false;
     return true;
 }
 
 bool event::wait()
 {
     std::unique_lock<std::mutex> lock(mutex_);
-
-    if (signaled_ == false)
-    {
-        cond_.wait(lock);
-    }
-
+    cond_.wait(lock, [this]() { return signaled_; });
     signaled_ = false;
     return true;
 }
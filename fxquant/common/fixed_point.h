@@ -1,85 +1,91 @@
 #pragma once
 #include <cmath>
-#include <cfenv>
+#include <limits>
 #include "common.h"
 
 namespace fx {
 
+// A decimal number with N digits after the point stored as an integer
+// number of 10^-N units, so the arithmetic and comparisons are exact.
 template <int N>
 class fixed_point
 {
 public:
-    fixed_point() : value_(0)
+    constexpr fixed_point() : value_(0)
     {
     }
 
-    fixed_point(double d) : value_(normalize(d))
-    {        
+    // rounds the value to N digits
+    explicit fixed_point(double d) : value_(llround(d * M))
+    {
     }
 
-    ALWAYS_INLINE static double normalize(double d)
+    constexpr static fixed_point from_raw(int64_t n)
     {
-        return round(d * M) / M;
+        return fixed_point(n, raw_tag());
     }
 
-    fixed_point operator+(fixed_point d) const
+    // the largest value, used as 'not set'
+    constexpr static fixed_point undefined()
     {
-        return fixed_point(value_ + d.value_);
+        return from_raw(std::numeric_limits<int64_t>::max());
     }
 
-    fixed_point operator+(double d) const
+    constexpr int64_t raw() const
     {
-        return fixed_point(value_ + d);
+        return value_;
     }
 
-    fixed_point operator-(fixed_point d) const
+    constexpr bool is_undefined() const
     {
-        return fixed_point(value_ - d.value_);
+        return value_ == std::numeric_limits<int64_t>::max();
     }
 
-    fixed_point operator-(double d) const
+    ALWAYS_INLINE static double normalize(double d)
     {
-        return fixed_point(value_ - d);
+        return static_cast<double>(llround(d * M)) / M;
     }
 
-    fixed_point operator*(double d) const
+    constexpr static int64_t scale()
     {
-        return fixed_point(value_ * d);
+        return M;
     }
 
-    fixed_point operator*(int n) const
+    fixed_point operator+(fixed_point d) const
     {
-        return fixed_point(value_ * n);
+        return from_raw(value_ + d.value_);
     }
 
-    fixed_point operator/(double d) const
+    fixed_point operator-(fixed_point d) const
     {
-        return fixed_point(value_ / d);
+        return from_raw(value_ - d.value_);
     }
 
-    fixed_point operator/(int n) const
+    fixed_point& operator+=(fixed_point d)
     {
-        return fixed_point(value_ / n);
+        value_ += d.value_;
+        return *this;
     }
 
-    bool operator==(fixed_point d) const
+    fixed_point& operator-=(fixed_point d)
     {
-        return value_ == d.value_;
+        value_ -= d.value_;
+        return *this;
     }
 
-    bool operator==(double d) const
+    fixed_point operator*(int n) const
     {
-        return value_ == normalize(d);
+        return from_raw(value_ * n);
     }
 
-    bool operator!=(fixed_point d) const
+    bool operator==(fixed_point d) const
     {
-        return !(*this == d);
+        return value_ == d.value_;
     }
 
-    bool operator!=(double d) const
+    bool operator!=(fixed_point d) const
     {
-        return !(*this == d);
+        return value_ != d.value_;
     }
 
     bool operator<(fixed_point d) const
@@ -87,59 +93,52 @@ public:
         return value_ < d.value_;
     }
 
-    bool operator<(double d) const
-    {
-        return value_ < normalize(d);
-    }
-
     bool operator<=(fixed_point d) const
     {
         return value_ <= d.value_;
     }
 
-    bool operator<=(double d) const
-    {
-        return value_ <= normalize(d);
-    }
-
     bool operator>(fixed_point d) const
     {
         return value_ > d.value_;
     }
 
-    bool operator>(double d) const
-    {
-        return value_ > normalize(d);
-    }
-
     bool operator>=(fixed_point d) const
     {
         return value_ >= d.value_;
     }
 
-    bool operator>=(double d) const
+    // the comparisons with double go through this conversion
+    operator double() const
     {
-        return value_ >= normalize(d);
+        return static_cast<double>(value_) / M;
     }
 
-    operator double()
-    {
-        return value_;
-    }
+private:
+    struct raw_tag {};
 
-    operator double() const
+    constexpr fixed_point(int64_t n, raw_tag) : value_(n)
     {
-        return value_;
     }
 
-private:
-    constexpr static int pow10(int n) // 10^n
+    constexpr static int64_t pow10(int n) // 10^n
     {
         return (n > 0) ? 10 * pow10(n - 1) : 1;
     }
 
 private:
-    static const int M = pow10(N);
-    double value_;
+    static constexpr int64_t M = pow10(N);
+    int64_t value_;
 };
+
+// The price of any symbol. 5 digits are exact for the 3 digit (JPY) symbols too,
+// so a single scale is used and the prices of different symbols are compatible.
+typedef fixed_point<5> price_type;
+
+// rounds the price to the given number of decimal digits (5 or 3)
+ALWAYS_INLINE double normalize_price(double d, int digits)
+{
+    return (digits == 5) ? fixed_point<5>::normalize(d) : fixed_point<3>::normalize(d);
+}
+
 } // namespace fx
@@ -0,0 +1,144 @@
+#include "debug.h"
+#include "mapped_file.h"
+
+#if defined(GNUC_ANY_TARGET)
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#elif defined(MSVC_ANY_TARGET)
+#include <windows.h>
+#else
+#error Unsupported platform
+#endif
+
+namespace fx {
+
+#if defined(GNUC_ANY_TARGET)
+
+mapped_file::mapped_file() : data_(nullptr), size_(0), fd_(-1)
+{
+}
+
+bool mapped_file::open(const std::string& path)
+{
+    close();
+
+    fd_ = ::open(path.c_str(), O_RDONLY);
+
+    if (fd_ < 0)
+    {
+        return false;
+    }
+
+    struct stat st;
+
+    if ((fstat(fd_, &st) == 0) && (st.st_size > 0))
+    {
+        void* p = mmap(nullptr, static_cast<size_t>(st.st_size), PROT_READ, MAP_PRIVATE, fd_, 0);
+
+        if (p != MAP_FAILED)
+        {
+            // the ticks are read front to back
+            madvise(p, static_cast<size_t>(st.st_size), MADV_SEQUENTIAL);
+
+            data_ = static_cast<byte_cptr>(p);
+            size_ = static_cast<size_t>(st.st_size);
+            return true;
+        }
+    }
+
+    DEBUG_TRACE("mapped_file::open(): failed to map '%s'", path.c_str());
+    close();
+    return false;
+}
+
+void mapped_file::close()
+{
+    if (data_)
+    {
+        munmap(const_cast<byte_ptr>(data_), size_);
+        data_ = nullptr;
+        size_ = 0;
+    }
+
+    if (fd_ >= 0)
+    {
+        ::close(fd_);
+        fd_ = -1;
+    }
+}
+
+#elif defined(MSVC_ANY_TARGET)
+
+mapped_file::mapped_file() : data_(nullptr), size_(0),
+    file_handle_(INVALID_HANDLE_VALUE), mapping_handle_(nullptr)
+{
+}
+
+bool mapped_file::open(const std::string& path)
+{
+    close();
+
+    file_handle_ = CreateFileA(path.c_str(), GENERIC_READ, FILE_SHARE_READ, nullptr,
+        OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL | FILE_FLAG_SEQUENTIAL_SCAN, nullptr);
+
+    if (file_handle_ == INVALID_HANDLE_VALUE)
+    {
+        return false;
+    }
+
+    LARGE_INTEGER file_size;
+
+    if (GetFileSizeEx(file_handle_, &file_size) && (file_size.QuadPart > 0))
+    {
+        mapping_handle_ = CreateFileMappingA(file_handle_, nullptr, PAGE_READONLY, 0, 0, nullptr);
+
+        if (mapping_handle_)
+        {
+            void* p = MapViewOfFile(mapping_handle_, FILE_MAP_READ, 0, 0, 0);
+
+            if (p)
+            {
+                data_ = static_cast<byte_cptr>(p);
+                size_ = static_cast<size_t>(file_size.QuadPart);
+                return true;
+            }
+        }
+    }
+
+    DEBUG_TRACE("mapped_file::open(): failed to map '%s'", path.c_str());
+    close();
+    return false;
+}
+
+void mapped_file::close()
+{
+    if (data_)
+    {
+        UnmapViewOfFile(data_);
+        data_ = nullptr;
+        size_ = 0;
+    }
+
+    if (mapping_handle_)
+    {
+        CloseHandle(mapping_handle_);
+        mapping_handle_ = nullptr;
+    }
+
+    if (file_handle_ != INVALID_HANDLE_VALUE)
+    {
+        CloseHandle(file_handle_);
+        file_handle_ = INVALID_HANDLE_VALUE;
+    }
+}
+
+#endif
+
+mapped_file::~mapped_file()
+{
+    close();
+}
+
+} // namespace fx
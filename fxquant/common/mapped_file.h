@@ -0,0 +1,48 @@
+#pragma once
+#include <string>
+#include "common.h"
+
+namespace fx {
+
+// read-only memory mapping of a whole file
+class mapped_file
+{
+public:
+    mapped_file();
+    ~mapped_file();
+
+    // delete copy constructor and assign operator
+    mapped_file(mapped_file const&) = delete;
+    mapped_file& operator=(mapped_file const&) = delete;
+
+    bool open(const std::string& path);
+    void close();
+
+    bool is_open() const
+    {
+        return data_ != nullptr;
+    }
+
+    byte_cptr data() const
+    {
+        return data_;
+    }
+
+    size_t size() const
+    {
+        return size_;
+    }
+
+private:
+    byte_cptr data_;
+    size_t size_;
+
+#if defined(MSVC_ANY_TARGET)
+    void* file_handle_;
+    void* mapping_handle_;
+#else
+    int fd_;
+#endif
+};
+
+} // namespace fx
@@ -113,15 +113,25 @@ bool bar_message::from_xml(const pugi::xml_node& message_node)
         return false;
     }
         
-    if (!read_value(bar_node, "o", bar_.o) ||
-        !read_value(bar_node, "h", bar_.h) ||
-        !read_value(bar_node, "l", bar_.l) ||
-        !read_value(bar_node, "c", bar_.c) ||
+    double o = 0.0;
+    double h = 0.0;
+    double l = 0.0;
+    double c = 0.0;
+
+    if (!read_value(bar_node, "o", o) ||
+        !read_value(bar_node, "h", h) ||
+        !read_value(bar_node, "l", l) ||
+        !read_value(bar_node, "c", c) ||
         !read_value(bar_node, "t", bar_.t))
     {
         return false;
     }
 
+    bar_.o = price_type(o);
+    bar_.h = price_type(h);
+    bar_.l = price_type(l);
+    bar_.c = price_type(c);
+
     return true;
 }
 
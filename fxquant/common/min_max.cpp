@@ -0,0 +1,63 @@
+#include "debug.h"
+#include "min_max.h"
+
+#if defined(MSVC_X86_64) || defined(GNUC_X86_64)
+#define MIN_MAX_SSE2
+#include <emmintrin.h>
+#endif
+
+namespace fx {
+
+void min_max(const double* data, size_t count, double& min_value, double& max_value)
+{
+    DEBUG_ASSERT(count > 0);
+
+    size_t i = 0;
+    double lo = data[0];
+    double hi = data[0];
+
+#if defined(MIN_MAX_SSE2)
+    if (count >= 4)
+    {
+        // two pairs of accumulators hide the latency of minpd/maxpd
+        __m128d lo0 = _mm_loadu_pd(data);
+        __m128d hi0 = lo0;
+        __m128d lo1 = _mm_loadu_pd(data + 2);
+        __m128d hi1 = lo1;
+
+        for (i = 4; i + 4 <= count; i += 4)
+        {
+            const __m128d a = _mm_loadu_pd(data + i);
+            const __m128d b = _mm_loadu_pd(data + i + 2);
+            lo0 = _mm_min_pd(lo0, a);
+            hi0 = _mm_max_pd(hi0, a);
+            lo1 = _mm_min_pd(lo1, b);
+            hi1 = _mm_max_pd(hi1, b);
+        }
+
+        lo0 = _mm_min_pd(lo0, lo1);
+        hi0 = _mm_max_pd(hi0, hi1);
+        lo0 = _mm_min_sd(lo0, _mm_unpackhi_pd(lo0, lo0));
+        hi0 = _mm_max_sd(hi0, _mm_unpackhi_pd(hi0, hi0));
+        lo = _mm_cvtsd_f64(lo0);
+        hi = _mm_cvtsd_f64(hi0);
+    }
+#endif
+
+    for ( ; i < count; ++i)
+    {
+        if (data[i] < lo)
+        {
+            lo = data[i];
+        }
+        else if (data[i] > hi)
+        {
+            hi = data[i];
+        }
+    }
+
+    min_value = lo;
+    max_value = hi;
+}
+
+} // namespace fx
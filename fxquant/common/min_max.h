@@ -0,0 +1,11 @@
+#pragma once
+#include <cstddef>
+#include "common.h"
+
+namespace fx {
+
+// the smallest and the largest value of a non-empty array,
+// SSE2 is used on x86-64 targets
+void min_max(const double* data, size_t count, double& min_value, double& max_value);
+
+} // namespace fx
@@ -0,0 +1,134 @@
+#pragma once
+#include <atomic>
+#include <memory>
+#include "common.h"
+#include "debug.h"
+
+namespace fx {
+
+// A bounded lock-free queue for any number of producer threads and one
+// consumer thread (D. Vyukov's bounded queue). Every cell carries a sequence
+// number which tells whether it is free for the producers or ready for the
+// consumer, so a producer only contends on the head index. The capacity is
+// rounded up to a power of two.
+template <typename T>
+class mpsc_ring
+{
+public:
+    explicit mpsc_ring(size_t capacity) :
+        mask_(round_up(capacity) - 1), cells_(new cell[mask_ + 1]),
+        head_(0), tail_(0)
+    {
+        for (size_t i = 0; i <= mask_; ++i)
+        {
+            cells_[i].sequence.store(i, std::memory_order_relaxed);
+        }
+    }
+
+    mpsc_ring(const mpsc_ring&) = delete;
+    mpsc_ring& operator=(const mpsc_ring&) = delete;
+
+    size_t capacity() const
+    {
+        return mask_ + 1;
+    }
+
+    // producer side, any thread
+    bool try_push(T&& value)
+    {
+        size_t head = head_.load(std::memory_order_relaxed);
+
+        for ( ; ; )
+        {
+            cell& c = cells_[head & mask_];
+            const size_t seq = c.sequence.load(std::memory_order_acquire);
+            const intptr_t diff = static_cast<intptr_t>(seq) - static_cast<intptr_t>(head);
+
+            if (diff == 0)
+            {
+                if (head_.compare_exchange_weak(head, head + 1, std::memory_order_relaxed))
+                {
+                    c.value = std::move(value);
+                    c.sequence.store(head + 1, std::memory_order_release);
+                    return true;
+                }
+            }
+            else if (diff < 0)
+            {
+                return false; // full
+            }
+            else
+            {
+                head = head_.load(std::memory_order_relaxed);
+            }
+        }
+    }
+
+    bool try_push(const T& value)
+    {
+        T copy(value);
+        return try_push(std::move(copy));
+    }
+
+    // consumer side, one thread
+    bool try_pop(T& value)
+    {
+        const size_t tail = tail_.load(std::memory_order_relaxed);
+        cell& c = cells_[tail & mask_];
+
+        if (c.sequence.load(std::memory_order_acquire) != tail + 1)
+        {
+            return false; // empty, or the producer has not finished the write yet
+        }
+
+        value = std::move(c.value);
+        c.sequence.store(tail + mask_ + 1, std::memory_order_release);
+        tail_.store(tail + 1, std::memory_order_relaxed);
+        return true;
+    }
+
+    // the number of the queued values, approximate while the producers are running
+    size_t size() const
+    {
+        const size_t head = head_.load(std::memory_order_relaxed);
+        const size_t tail = tail_.load(std::memory_order_relaxed);
+        return (head > tail) ? (head - tail) : 0;
+    }
+
+    bool empty() const
+    {
+        return size() == 0;
+    }
+
+private:
+    struct cell
+    {
+        std::atomic<size_t> sequence;
+        T value;
+    };
+
+    static size_t round_up(size_t n)
+    {
+        DEBUG_REQUIRE(n > 0);
+        size_t r = 1;
+
+        while (r < n)
+        {
+            r <<= 1;
+        }
+
+        return r;
+    }
+
+private:
+    const size_t mask_;
+    const std::unique_ptr<cell[]> cells_;
+
+    // written by the producers
+    alignas(constants::cache_line_size) std::atomic<size_t> head_;
+
+    // written by the consumer
+    alignas(constants::cache_line_size) std::atomic<size_t> tail_;
+};
+
+} // namespace fx
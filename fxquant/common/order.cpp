@@ -13,7 +13,7 @@ order_id_type base_order::auto_order_id_ = 0;
 
 bool base_buy_order::is_valid() const
 {
-    if ((order_price_ == undefined_value<double>()) || (order_price_ <= 0.0) || (volume_ < 0.01) ||
+    if (order_price_.is_undefined() || (order_price_ <= price_type()) || (volume_ < 0.01) ||
         (has_stop_loss() && (stop_loss_ >= order_price_)) ||
         (has_take_profit() && (take_profit_ <= order_price_)))
     {
@@ -30,17 +30,17 @@ double base_buy_order::get_profit() const
         DEBUG_ASSERT(0); // use get_profit(tick) instead?
         return undefined_value<double>();
     }
-    return (close_price_ - open_price_) / symbol_pip(symbol_) * volume_;
+    return static_cast<double>(close_price_ - open_price_) / symbol_pip(symbol_) * volume_;
 }
 
 double base_buy_order::get_profit(const tick_data& tick) const
 {
-    return (tick.get_bid() - open_price_) / symbol_pip(symbol_) * volume_;
+    return static_cast<double>(tick.get_bid_price() - open_price_) / symbol_pip(symbol_) * volume_;
 }
 
 bool base_sell_order::is_valid() const
 {
-    if ((order_price_ == undefined_value<double>()) || (order_price_ <= 0.0) || (volume_ < 0.01) ||
+    if (order_price_.is_undefined() || (order_price_ <= price_type()) || (volume_ < 0.01) ||
         (has_stop_loss() && (stop_loss_ <= order_price_)) ||
         (has_take_profit() && (take_profit_ >= order_price_)))
     {
@@ -56,12 +56,12 @@ double base_sell_order::get_profit() const
     {
         return undefined_value<double>();
     }
-    return (open_price_ - close_price_) / symbol_pip(symbol_) * volume_;
+    return static_cast<double>(open_price_ - close_price_) / symbol_pip(symbol_) * volume_;
 }
 
 double base_sell_order::get_profit(const tick_data& tick) const
 {
-    return (open_price_ - tick.get_ask()) / symbol_pip(symbol_) * volume_;
+    return static_cast<double>(open_price_ - tick.get_ask_price()) / symbol_pip(symbol_) * volume_;
 }
 
 buy_order::buy_order(symbol sym, double volume, double order_price,
@@ -184,49 +184,35 @@ sell_stop_order::sell_stop_order(symbol sym, double volume, double order_price,
     }
 }
 
-std::string buy_order::make_xml_header() const
-{
-    std::ostringstream oss;
-    oss << "<order id=\"" << id_ << "\" type=\"buy_order\">\n";
-    return oss.str();
-}
-
-std::string buy_limit_order::make_xml_header() const
-{
-    std::ostringstream oss;
-    oss << "<order id=\"" << id_ << "\" type=\"buy_limit_order\">\n";
-    return oss.str();
-}
-
-std::string buy_stop_order::make_xml_header() const
-{
-    std::ostringstream oss;
-    oss << "<order id=\"" << id_ << "\" type=\"buy_stop_order\">\n";
-    return oss.str();
-}
-
-std::string sell_order::make_xml_header() const
-{
-    std::ostringstream oss;
-    oss << "<order id=\"" << id_ << "\" type=\"sell_order\">\n";
-    return oss.str();
-}
+namespace {
 
-std::string sell_limit_order::make_xml_header() const
+const char* order_type_to_string(order_type type)
 {
-    std::ostringstream oss;
-    oss << "<order id=\"" << id_ << "\" type=\"sell_limit_order\">\n";
-    return oss.str();
+    switch (type)
+    {
+    case order_type::buy:
+        return "buy_order";
+    case order_type::buy_limit:
+        return "buy_limit_order";
+    case order_type::buy_stop:
+        return "buy_stop_order";
+    case order_type::sell:
+        return "sell_order";
+    case order_type::sell_limit:
+        return "sell_limit_order";
+    case order_type::sell_stop:
+        return "sell_stop_order";
+    default:
+        return "undefined";
+    }
 }
 
-std::string sell_stop_order::make_xml_header() const
+double price_to_double(price_type p)
 {
-    std::ostringstream oss;
-    oss << "<order id=\"" << id_ << "\" type=\"sell_stop_order\">\n";
-    return oss.str();
+    return p.is_undefined() ? undefined_value<double>() : static_cast<double>(p);
 }
 
-std::string base_order::to_xml_message(order_action action) const
+std::string make_xml_message(const order_snapshot& o, order_action action, const std::string& comment)
 {
     std::ostringstream oss;
     oss.precision(7);
@@ -235,7 +221,7 @@ std::string base_order::to_xml_message(order_action action) const
     const std::string indent2(4, ' ');
 
     oss << "<message id=\"order\">\n";
-    oss << indent1 << make_xml_header();
+    oss << indent1 << "<order id=\"" << o.id << "\" type=\"" << order_type_to_string(o.type) << "\">\n";
 
     if (action != order_action::undefined)
     {
@@ -258,50 +244,50 @@ std::string base_order::to_xml_message(order_action action) const
         oss << "</action>\n";
     }
 
-    oss << indent2 << "<symbol>" << symbol_to_string(symbol_) << "</symbol>\n";
+    oss << indent2 << "<symbol>" << symbol_to_string(o.sym) << "</symbol>\n";
 
-    if ((volume_ > 0) && (volume_ != undefined_value<double>()))
+    if ((o.volume > 0) && (o.volume != undefined_value<double>()))
     {
-        oss << indent2 << "<volume>" << volume_ << "</volume>\n";
+        oss << indent2 << "<volume>" << o.volume << "</volume>\n";
     }
 
-    oss << indent2 << "<order_price>" << order_price_ << "</order_price>\n";
+    oss << indent2 << "<order_price>" << price_to_double(o.order_price) << "</order_price>\n";
 
-    if ((open_price_ > 0) && (open_price_ != undefined_value<double>()))
+    if (o.is_opened() && (o.open_price > price_type()))
     {
-        oss << indent2 << "<open_price>" << open_price_ << "</open_price>\n";
+        oss << indent2 << "<open_price>" << price_to_double(o.open_price) << "</open_price>\n";
     }
 
-    if ((action != order_action::opened) && (close_price_ > 0) && (close_price_ != undefined_value<double>()))
+    if ((action != order_action::opened) && o.is_closed() && (o.close_price > price_type()))
     {
-        oss << indent2 << "<close_price>" << close_price_ << "</close_price>\n";
+        oss << indent2 << "<close_price>" << price_to_double(o.close_price) << "</close_price>\n";
     }
 
-    if (stop_loss_ != undefined_value<double>())
+    if (!o.stop_loss.is_undefined())
     {
-        oss << indent2 << "<stop_loss>" << stop_loss_ << "</stop_loss>\n";
+        oss << indent2 << "<stop_loss>" << price_to_double(o.stop_loss) << "</stop_loss>\n";
     }
 
-    if (take_profit_ != undefined_value<double>())
+    if (!o.take_profit.is_undefined())
     {
-        oss << indent2 << "<take_profit>" << take_profit_ << "</take_profit>\n";
+        oss << indent2 << "<take_profit>" << price_to_double(o.take_profit) << "</take_profit>\n";
     }
 
-    if (open_time_.time_since_epoch().count() > 0)
+    if (o.open_time.time_since_epoch().count() > 0)
     {
-        auto ms = duration_cast<milliseconds>(open_time_.time_since_epoch()).count();
+        auto ms = duration_cast<milliseconds>(o.open_time.time_since_epoch()).count();
         oss << indent2 << "<open_time>" << ms << "</open_time>\n";
     }
 
-    if ((action != order_action::opened) && (close_time_.time_since_epoch().count() > 0))
+    if ((action != order_action::opened) && (o.close_time.time_since_epoch().count() > 0))
     {
-        auto ms = duration_cast<milliseconds>(close_time_.time_since_epoch()).count();
+        auto ms = duration_cast<milliseconds>(o.close_time.time_since_epoch()).count();
         oss << indent2 << "<close_time>" << ms << "</close_time>\n";
     }
 
-    if (!comment_.empty())
+    if (!comment.empty())
     {
-        oss << indent2 << "<comment>" << comment_ << "</comment_>\n";
+        oss << indent2 << "<comment>" << comment << "</comment_>\n";
     }
 
     oss << indent1 << "</order>\n";
@@ -310,6 +296,35 @@ std::string base_order::to_xml_message(order_action action) const
     return oss.str();
 }
 
+} // namespace
+
+std::string base_order::to_xml_message(order_action action) const
+{
+    return make_xml_message(order_snapshot(*this), action, comment_);
+}
+
+order_snapshot::order_snapshot() :
+    type(order_type::undefined), id(0), sym(symbol::undefined), volume(undefined_value<double>()),
+    order_price(price_type::undefined()), open_price(price_type::undefined()),
+    close_price(price_type::undefined()), stop_loss(price_type::undefined()),
+    take_profit(price_type::undefined())
+{
+}
+
+order_snapshot::order_snapshot(const base_order& order) :
+    type(order.get_type()), id(order.get_id()), sym(order.get_symbol()), volume(order.get_volume()),
+    order_price(order.get_order_price_value()), open_price(order.get_open_price_value()),
+    close_price(order.get_close_price_value()), stop_loss(order.get_stop_loss_value()),
+    take_profit(order.get_take_profit_value()), open_time(order.get_open_time()),
+    close_time(order.get_close_time())
+{
+}
+
+std::string order_snapshot::to_xml_message(order_action action) const
+{
+    return make_xml_message(*this, action, std::string());
+}
+
 order_ptr from_xml_message(const std::string& xml, order_action& action)
 {
     order_ptr optr;
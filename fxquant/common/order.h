@@ -13,6 +13,8 @@ typedef unsigned long order_id_type;
 
 enum class order_action { undefined, submitted, opened, closed, modified, deleted };
 
+enum class order_type { undefined, buy, buy_limit, buy_stop, sell, sell_limit, sell_stop };
+
 class base_order
 {
 public:
@@ -25,9 +27,9 @@ public:
 protected:
     base_order(symbol sym, double volume, double order_price,
         double stop_loss, double take_profit, order_id_type id) :
-        id_(id), symbol_(sym), volume_(volume), order_price_(order_price),
-        open_price_(undefined_value<double>()), close_price_(undefined_value<double>()),
-        stop_loss_(stop_loss), take_profit_(take_profit)
+        id_(id), symbol_(sym), volume_(volume), order_price_(to_price(order_price)),
+        open_price_(price_type::undefined()), close_price_(price_type::undefined()),
+        stop_loss_(to_price(stop_loss)), take_profit_(to_price(take_profit))
     {
         if (id_ == 0)
         {
@@ -60,19 +62,19 @@ public:
 
     bool has_stop_loss() const
     {
-        return stop_loss_ != undefined_value<double>();
+        return !stop_loss_.is_undefined();
     }
 
     double get_stop_loss() const
     {
-        return stop_loss_;
+        return from_price(stop_loss_);
     }
 
     virtual bool set_stop_loss(double value)
     {
         if (value > 0.0)
         {
-            stop_loss_ = value;
+            stop_loss_ = to_price(value);
             return true;
         }
 
@@ -81,24 +83,24 @@ public:
 
     void reset_stop_loss()
     {
-        stop_loss_ = undefined_value<double>();
+        stop_loss_ = price_type::undefined();
     }
 
     bool has_take_profit() const
     {
-        return take_profit_ != undefined_value<double>();
+        return !take_profit_.is_undefined();
     }
 
     double get_take_profit() const
     {
-        return take_profit_;
+        return from_price(take_profit_);
     }
 
     virtual bool set_take_profit(double value)
     {
         if (value > 0.0)
         {
-            take_profit_ = value;
+            take_profit_ = to_price(value);
             return true;
         }
 
@@ -107,32 +109,58 @@ public:
 
     void reset_take_profit()
     {
-        take_profit_ = undefined_value<double>();
+        take_profit_ = price_type::undefined();
     }
 
     double get_order_price() const
     {
-        return order_price_;
+        return from_price(order_price_);
     }
 
     double get_open_price() const
     {
-        return open_price_;
+        return from_price(open_price_);
     }
 
     void set_open_price(double open_price)
     {
-        open_price_ = open_price;
+        open_price_ = to_price(open_price);
     }
 
     double get_close_price() const
     {
-        return close_price_;
+        return from_price(close_price_);
     }
 
     void set_close_price(double close_price)
     {
-        close_price_ = close_price;
+        close_price_ = to_price(close_price);
+    }
+
+    // the exact prices, price_type::undefined() if not set
+    price_type get_order_price_value() const
+    {
+        return order_price_;
+    }
+
+    price_type get_open_price_value() const
+    {
+        return open_price_;
+    }
+
+    price_type get_close_price_value() const
+    {
+        return close_price_;
+    }
+
+    price_type get_stop_loss_value() const
+    {
+        return stop_loss_;
+    }
+
+    price_type get_take_profit_value() const
+    {
+        return take_profit_;
     }
 
     const tick_data& get_open_tick() const
@@ -187,12 +215,12 @@ public:
 
     bool is_opened() const
     {
-        return open_price_ != undefined_value<double>();
+        return !open_price_.is_undefined();
     }
 
     bool is_closed() const
     {
-        return close_price_ != undefined_value<double>();
+        return !close_price_.is_undefined();
     }
 
     // open the order
@@ -211,25 +239,37 @@ public:
     virtual double get_profit() const = 0;
     virtual double get_profit(const tick_data& tick) const = 0;
 
+    virtual order_type get_type() const = 0;
+
     virtual std::shared_ptr<base_order> clone() const = 0;
 
     std::string to_xml_message(order_action action = order_action::undefined) const;
 
 protected:
-    virtual std::string make_xml_header() const = 0;
+    // undefined_value<double>() is kept as price_type::undefined() and back
+    static price_type to_price(double d)
+    {
+        return (d == undefined_value<double>()) ? price_type::undefined() : price_type(d);
+    }
+
+    static double from_price(price_type p)
+    {
+        return p.is_undefined() ? undefined_value<double>() : static_cast<double>(p);
+    }
+
     friend std::shared_ptr<base_order> from_xml_message(const std::string& xml);
 
 protected:
     order_id_type id_; // ticket #
     const symbol symbol_;      // symbol for trading
     const double volume_;      // number of lots (0.01 lot = 1000 currency units)
-    const double order_price_; // order price
+    const price_type order_price_; // order price
 
-    double open_price_;  // open price
-    double close_price_; // close price
+    price_type open_price_;  // open price
+    price_type close_price_; // close price
 
-    double stop_loss_;   // stop loss level
-    double take_profit_; // take profit level
+    price_type stop_loss_;   // stop loss level
+    price_type take_profit_; // take profit level
 
     timepoint_type open_time_;  // open time
     timepoint_type close_time_; // close time
@@ -249,7 +289,7 @@ class base_buy_order : public base_order
 public:
     bool set_stop_loss(double value) override
     {
-        if ((value == undefined_value<double>()) || (value < order_price_))
+        if ((value == undefined_value<double>()) || (to_price(value) < order_price_))
         {
             return base_order::set_stop_loss(value);
         }
@@ -259,7 +299,7 @@ public:
 
     bool set_take_profit(double value) override
     {
-        if ((value == undefined_value<double>()) || (value > order_price_))
+        if ((value == undefined_value<double>()) || (to_price(value) > order_price_))
         {
             return base_order::set_take_profit(value);
         }
@@ -271,8 +311,8 @@ public:
     {
         if (is_opened() && !is_closed())
         {
-            if ((has_stop_loss() && (tick.get_bid() <= stop_loss_)) ||
-                (has_take_profit() && (tick.get_bid() >= take_profit_)))
+            if ((has_stop_loss() && (tick.get_bid_price() <= stop_loss_)) ||
+                (has_take_profit() && (tick.get_bid_price() >= take_profit_)))
             {
                 return true;
             }
@@ -285,7 +325,7 @@ public:
     {
         if (check_open(tick))
         {
-            open_price_ = tick.get_ask();
+            open_price_ = tick.get_ask_price();
             open_time_ = tick.get_time();//std::chrono::system_clock::now();
             open_tick_ = tick;
             return true;
@@ -298,7 +338,7 @@ public:
     {
         if (is_opened() && !is_closed())
         {
-            close_price_ = tick.get_bid();
+            close_price_ = tick.get_bid_price();
             close_time_ = tick.get_time(); //std::chrono::system_clock::now();
             close_tick_ = tick;
             return true;
@@ -330,7 +370,7 @@ class base_sell_order : public base_order
 public:
     bool set_stop_loss(double value) override
     {
-        if ((value == undefined_value<double>()) || (value > order_price_))
+        if ((value == undefined_value<double>()) || (to_price(value) > order_price_))
         {
             return base_order::set_stop_loss(value);
         }
@@ -340,7 +380,7 @@ public:
 
     bool set_take_profit(double value) override
     {
-        if ((value == undefined_value<double>()) || (value < order_price_))
+        if ((value == undefined_value<double>()) || (to_price(value) < order_price_))
         {
             return base_order::set_take_profit(value);
         }
@@ -352,8 +392,8 @@ public:
     {
         if (is_opened() && !is_closed())
         {
-            if ((has_stop_loss() && (tick.get_ask() >= stop_loss_)) ||
-                (has_take_profit() && (tick.get_ask() <= take_profit_)))
+            if ((has_stop_loss() && (tick.get_ask_price() >= stop_loss_)) ||
+                (has_take_profit() && (tick.get_ask_price() <= take_profit_)))
             {
                 return true;
             }
@@ -366,7 +406,7 @@ public:
     {
         if (check_open(tick))
         {
-            open_price_ = tick.get_bid();
+            open_price_ = tick.get_bid_price();
             open_time_ = tick.get_time();//std::chrono::system_clock::now();
             open_tick_ = tick;
             return true;
@@ -379,7 +419,7 @@ public:
     {
         if (is_opened() && !is_closed())
         {
-            close_price_ = tick.get_ask();
+            close_price_ = tick.get_ask_price();
             close_time_ = tick.get_time(); //std::chrono::system_clock::now();
             close_tick_ = tick;
             return true;
@@ -422,13 +462,15 @@ public:
         return !is_opened();
     }
 
+    order_type get_type() const override final
+    {
+        return order_type::buy;
+    }
+
     std::shared_ptr<base_order> clone() const override final
     {
         return std::make_shared<buy_order>(*this);
     }
-
-private:
-    std::string make_xml_header() const override;
 };
 
 class buy_limit_order : public base_buy_order
@@ -444,16 +486,18 @@ public:
 
     bool check_open(const tick_data& tick) const override final
     {
-        return !is_opened() && (tick.get_ask() <= order_price_);
+        return !is_opened() && (tick.get_ask_price() <= order_price_);
+    }
+
+    order_type get_type() const override final
+    {
+        return order_type::buy_limit;
     }
 
     std::shared_ptr<base_order> clone() const override final
     {
         return std::make_shared<buy_limit_order>(*this);
     }
-
-private:
-    std::string make_xml_header() const override;
 };
 
 class buy_stop_order : public base_buy_order
@@ -469,16 +513,18 @@ public:
 
     bool check_open(const tick_data& tick) const override final
     {
-        return !is_opened() && (tick.get_ask() >= order_price_);
+        return !is_opened() && (tick.get_ask_price() >= order_price_);
+    }
+
+    order_type get_type() const override final
+    {
+        return order_type::buy_stop;
     }
 
     std::shared_ptr<base_order> clone() const override final
     {
         return std::make_shared<buy_stop_order>(*this);
     }
-
-private:
-    std::string make_xml_header() const override;
 };
 
 class sell_order : public base_sell_order
@@ -497,13 +543,15 @@ public:
         return !is_opened();
     }
 
+    order_type get_type() const override final
+    {
+        return order_type::sell;
+    }
+
     std::shared_ptr<base_order> clone() const override final
     {
         return std::make_shared<sell_order>(*this);
     }
-
-private:
-    std::string make_xml_header() const override;
 };
 
 class sell_limit_order : public base_sell_order
@@ -519,16 +567,18 @@ public:
 
     bool check_open(const tick_data& tick) const override final
     {
-        return !is_opened() && (tick.get_bid() >= order_price_);
+        return !is_opened() && (tick.get_bid_price() >= order_price_);
+    }
+
+    order_type get_type() const override final
+    {
+        return order_type::sell_limit;
     }
 
     std::shared_ptr<base_order> clone() const override final
     {
         return std::make_shared<sell_limit_order>(*this);
     }
-
-private:
-    std::string make_xml_header() const override;
 };
 
 class sell_stop_order : public base_sell_order
@@ -544,21 +594,58 @@ public:
 
     bool check_open(const tick_data& tick) const override final
     {
-        return !is_opened() && (tick.get_bid() <= order_price_);
+        return !is_opened() && (tick.get_bid_price() <= order_price_);
+    }
+
+    order_type get_type() const override final
+    {
+        return order_type::sell_stop;
     }
 
     std::shared_ptr<base_order> clone() const override final
     {
         return std::make_shared<sell_stop_order>(*this);
     }
-
-private:
-    std::string make_xml_header() const override;
 };
 
 typedef std::shared_ptr<base_order> order_ptr;
 typedef std::shared_ptr<const base_order> order_cptr;
 
+// A fixed-size copy of the order state, passed by value through the order
+// events without touching the heap. The comment and the custom data are not
+// copied, they do not fit in a fixed size.
+struct order_snapshot
+{
+    order_type type;
+    order_id_type id;
+    symbol sym;
+    double volume;
+
+    price_type order_price;
+    price_type open_price;  // price_type::undefined() if not opened
+    price_type close_price; // price_type::undefined() if not closed
+    price_type stop_loss;   // price_type::undefined() if not set
+    price_type take_profit; // price_type::undefined() if not set
+
+    timepoint_type open_time;
+    timepoint_type close_time;
+
+    order_snapshot();
+    explicit order_snapshot(const base_order& order);
+
+    bool is_opened() const
+    {
+        return !open_price.is_undefined();
+    }
+
+    bool is_closed() const
+    {
+        return !close_price.is_undefined();
+    }
+
+    std::string to_xml_message(order_action action = order_action::undefined) const;
+};
+
 order_ptr from_xml_message(const std::string& xml, order_action& action);
 
 } // namespace fx
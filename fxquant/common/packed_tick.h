@@ -0,0 +1,73 @@
+#pragma once
+#include <chrono>
+#include <cstdint>
+#include <limits>
+#include "types.h"
+#include "debug.h"
+#include "common.h"
+#include "tick_data.h"
+
+namespace fx {
+
+// A tick packed into 16 bytes for the tick caches and the replay:
+// the time in microseconds since the epoch, the bid and the spread in
+// price_type units. The spread is signed, so the crossed and locked quotes
+// of the real feeds are kept as they are. The conversion to and from tick_data is lossless
+// for the prices below 21474.83647 and the times in whole microseconds.
+class packed_tick
+{
+public:
+    packed_tick() : time_us_(0), bid_(0), spread_(0)
+    {
+    }
+
+    explicit packed_tick(const tick_data& tick) :
+        time_us_(std::chrono::duration_cast<std::chrono::microseconds>(tick.get_time().time_since_epoch()).count()),
+        bid_(static_cast<int32_t>(tick.get_bid_price().raw())),
+        spread_(static_cast<int32_t>(tick.get_ask_price().raw() - tick.get_bid_price().raw()))
+    {
+        DEBUG_ASSERT(fits(tick));
+    }
+
+    // true if the tick can be packed without a loss
+    static bool fits(const tick_data& tick)
+    {
+        const int64_t bid = tick.get_bid_price().raw();
+        const int64_t spread = tick.get_ask_price().raw() - bid;
+
+        return (bid >= 0) && (bid <= std::numeric_limits<int32_t>::max()) &&
+            (spread >= std::numeric_limits<int32_t>::min()) &&
+            (spread <= std::numeric_limits<int32_t>::max());
+    }
+
+    ALWAYS_INLINE tick_data to_tick() const
+    {
+        return tick_data(price_type::from_raw(bid_), price_type::from_raw(static_cast<int64_t>(bid_) + spread_),
+            get_time());
+    }
+
+    timepoint_type get_time() const
+    {
+        return timepoint_type(std::chrono::duration_cast<timepoint_type::duration>(
+            std::chrono::microseconds(time_us_)));
+    }
+
+    int64_t get_time_us() const
+    {
+        return time_us_;
+    }
+
+    bool operator <(const packed_tick& rhs) const
+    {
+        return (time_us_ < rhs.time_us_);
+    }
+
+private:
+    int64_t time_us_;
+    int32_t bid_;    // price_type units
+    int32_t spread_; // price_type units
+};
+
+STATIC_ASSERT(sizeof(packed_tick) == 16);
+
+} // namespace fx
@@ -0,0 +1,302 @@
+#include "debug.h"
+#include "shared_memory.h"
+
+#if defined(GNUC_ANY_TARGET)
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#elif defined(MSVC_ANY_TARGET)
+#include <windows.h>
+#else
+#error Unsupported platform
+#endif
+
+namespace {
+
+size_t round_up(size_t size, size_t page_size)
+{
+    return (size + page_size - 1) / page_size * page_size;
+}
+}
+
+namespace fx {
+
+#if defined(GNUC_ANY_TARGET)
+
+namespace {
+
+// a file on hugetlbfs is backed by huge pages, the pages must be reserved
+// by the administrator (vm.nr_hugepages), otherwise the POSIX shared memory is used
+const std::string hugetlbfs_dir = "/dev/hugepages/";
+const size_t huge_page_size = 2 * 1024 * 1024;
+
+std::string shm_name(const std::string& name)
+{
+    return "/" + name;
+}
+
+byte_ptr map_fd(int fd, size_t size, bool writable)
+{
+    void* p = mmap(nullptr, size, writable ? (PROT_READ | PROT_WRITE) : PROT_READ, MAP_SHARED, fd, 0);
+    return (p != MAP_FAILED) ? static_cast<byte_ptr>(p) : nullptr;
+}
+}
+
+shared_memory::shared_memory() : data_(nullptr), size_(0), huge_pages_(false)
+{
+}
+
+bool shared_memory::create(const std::string& name, size_t size)
+{
+    close();
+    remove(name);
+
+    if (size == 0)
+    {
+        return false;
+    }
+
+    const std::string huge_path = hugetlbfs_dir + name;
+    int fd = ::open(huge_path.c_str(), O_RDWR | O_CREAT | O_EXCL, 0644);
+
+    if (fd >= 0)
+    {
+        const size_t huge_size = round_up(size, huge_page_size);
+
+        if (ftruncate(fd, static_cast<off_t>(huge_size)) == 0)
+        {
+            data_ = map_fd(fd, huge_size, true);
+        }
+
+        ::close(fd);
+
+        if (data_)
+        {
+            size_ = huge_size;
+            huge_pages_ = true;
+            return true;
+        }
+
+        unlink(huge_path.c_str());
+    }
+
+    fd = shm_open(shm_name(name).c_str(), O_RDWR | O_CREAT | O_EXCL, 0644);
+
+    if (fd < 0)
+    {
+        DEBUG_TRACE("shared_memory::create(): failed to create '%s'", name.c_str());
+        return false;
+    }
+
+    if (ftruncate(fd, static_cast<off_t>(size)) == 0)
+    {
+        data_ = map_fd(fd, size, true);
+    }
+
+    ::close(fd);
+
+    if (!data_)
+    {
+        DEBUG_TRACE("shared_memory::create(): failed to map '%s'", name.c_str());
+        shm_unlink(shm_name(name).c_str());
+        return false;
+    }
+
+    size_ = size;
+
+#if defined(MADV_HUGEPAGE)
+    // transparent huge pages, if they are enabled for shared memory
+    madvise(data_, size_, MADV_HUGEPAGE);
+#endif
+
+    return true;
+}
+
+bool shared_memory::open(const std::string& name)
+{
+    close();
+
+    bool huge_pages = true;
+    int fd = ::open((hugetlbfs_dir + name).c_str(), O_RDONLY);
+
+    if (fd < 0)
+    {
+        huge_pages = false;
+        fd = shm_open(shm_name(name).c_str(), O_RDONLY, 0);
+
+        if (fd < 0)
+        {
+            return false;
+        }
+    }
+
+    struct stat st;
+
+    if ((fstat(fd, &st) == 0) && (st.st_size > 0))
+    {
+        data_ = map_fd(fd, static_cast<size_t>(st.st_size), false);
+    }
+
+    ::close(fd);
+
+    if (!data_)
+    {
+        DEBUG_TRACE("shared_memory::open(): failed to map '%s'", name.c_str());
+        return false;
+    }
+
+    size_ = static_cast<size_t>(st.st_size);
+    huge_pages_ = huge_pages;
+    return true;
+}
+
+void shared_memory::close()
+{
+    if (data_)
+    {
+        munmap(data_, size_);
+        data_ = nullptr;
+        size_ = 0;
+        huge_pages_ = false;
+    }
+}
+
+void shared_memory::remove(const std::string& name)
+{
+    unlink((hugetlbfs_dir + name).c_str());
+    shm_unlink(shm_name(name).c_str());
+}
+
+#elif defined(MSVC_ANY_TARGET)
+
+namespace {
+
+std::string mapping_name(const std::string& name)
+{
+    return "Local\\" + name;
+}
+}
+
+shared_memory::shared_memory() : data_(nullptr), size_(0), huge_pages_(false),
+    mapping_handle_(nullptr)
+{
+}
+
+bool shared_memory::create(const std::string& name, size_t size)
+{
+    close();
+
+    if (size == 0)
+    {
+        return false;
+    }
+
+    // large pages need the 'Lock pages in memory' privilege
+    const size_t large_page_size = GetLargePageMinimum();
+
+    if (large_page_size > 0)
+    {
+        const uint64_t large_size = round_up(size, large_page_size);
+
+        mapping_handle_ = CreateFileMappingA(INVALID_HANDLE_VALUE, nullptr,
+            PAGE_READWRITE | SEC_COMMIT | SEC_LARGE_PAGES,
+            static_cast<DWORD>(large_size >> 32), static_cast<DWORD>(large_size),
+            mapping_name(name).c_str());
+
+        if (mapping_handle_)
+        {
+            DWORD access = FILE_MAP_WRITE;
+#if defined(FILE_MAP_LARGE_PAGES)
+            access |= FILE_MAP_LARGE_PAGES;
+#endif
+            data_ = static_cast<byte_ptr>(MapViewOfFile(mapping_handle_, access, 0, 0, 0));
+
+            if (data_)
+            {
+                size_ = static_cast<size_t>(large_size);
+                huge_pages_ = true;
+                return true;
+            }
+
+            CloseHandle(mapping_handle_);
+            mapping_handle_ = nullptr;
+        }
+    }
+
+    const uint64_t size64 = size;
+
+    mapping_handle_ = CreateFileMappingA(INVALID_HANDLE_VALUE, nullptr, PAGE_READWRITE,
+        static_cast<DWORD>(size64 >> 32), static_cast<DWORD>(size64), mapping_name(name).c_str());
+
+    if (mapping_handle_)
+    {
+        data_ = static_cast<byte_ptr>(MapViewOfFile(mapping_handle_, FILE_MAP_WRITE, 0, 0, 0));
+
+        if (data_)
+        {
+            size_ = size;
+            return true;
+        }
+    }
+
+    DEBUG_TRACE("shared_memory::create(): failed to create '%s'", name.c_str());
+    close();
+    return false;
+}
+
+bool shared_memory::open(const std::string& name)
+{
+    close();
+
+    mapping_handle_ = OpenFileMappingA(FILE_MAP_READ, FALSE, mapping_name(name).c_str());
+
+    if (!mapping_handle_)
+    {
+        return false;
+    }
+
+    data_ = static_cast<byte_ptr>(MapViewOfFile(mapping_handle_, FILE_MAP_READ, 0, 0, 0));
+    MEMORY_BASIC_INFORMATION info;
+
+    if (data_ && (VirtualQuery(data_, &info, sizeof(info)) != 0))
+    {
+        size_ = info.RegionSize;
+        return true;
+    }
+
+    DEBUG_TRACE("shared_memory::open(): failed to map '%s'", name.c_str());
+    close();
+    return false;
+}
+
+void shared_memory::close()
+{
+    if (data_)
+    {
+        UnmapViewOfFile(data_);
+        data_ = nullptr;
+        size_ = 0;
+        huge_pages_ = false;
+    }
+
+    if (mapping_handle_)
+    {
+        CloseHandle(mapping_handle_);
+        mapping_handle_ = nullptr;
+    }
+}
+
+void shared_memory::remove(const std::string&)
+{
+    // the segment is destroyed with the last handle
+}
+
+#endif
+
+shared_memory::~shared_memory()
+{
+    close();
+}
+
+} // namespace fx
@@ -0,0 +1,64 @@
+#pragma once
+#include <string>
+#include "common.h"
+
+namespace fx {
+
+// A named shared memory segment. The creator gets a writable mapping,
+// other processes attach to it read-only. Huge (large) pages are used
+// when the system allows it, see huge_pages().
+class shared_memory
+{
+public:
+    shared_memory();
+    ~shared_memory();
+
+    // delete copy constructor and assign operator
+    shared_memory(shared_memory const&) = delete;
+    shared_memory& operator=(shared_memory const&) = delete;
+
+    // creates a new segment, an existing segment with the same name is replaced
+    bool create(const std::string& name, size_t size);
+
+    // attaches to an existing segment read-only
+    bool open(const std::string& name);
+
+    void close();
+
+    // removes the segment name, the attached processes keep their mappings;
+    // on Windows the segment lives while any process has it open
+    static void remove(const std::string& name);
+
+    bool is_open() const
+    {
+        return data_ != nullptr;
+    }
+
+    // writable only if the segment has been created by this object
+    byte_ptr data() const
+    {
+        return data_;
+    }
+
+    // the size of the mapping, may be rounded up to the page size
+    size_t size() const
+    {
+        return size_;
+    }
+
+    bool huge_pages() const
+    {
+        return huge_pages_;
+    }
+
+private:
+    byte_ptr data_;
+    size_t size_;
+    bool huge_pages_;
+
+#if defined(MSVC_ANY_TARGET)
+    void* mapping_handle_;
+#endif
+};
+
+} // namespace fx
@@ -0,0 +1,112 @@
+#pragma once
+#include <atomic>
+#include <vector>
+#include "common.h"
+#include "debug.h"
+
+namespace fx {
+
+// A bounded lock-free queue for exactly one producer and one consumer thread.
+// The capacity is rounded up to a power of two. The producer calls
+// try_push() and close(), the consumer calls try_pop() and is_closed().
+template <typename T>
+class spsc_ring
+{
+public:
+    explicit spsc_ring(size_t capacity) :
+        mask_(round_up(capacity) - 1), buffer_(mask_ + 1),
+        head_(0), tail_cache_(0), tail_(0), head_cache_(0), closed_(false)
+    {
+    }
+
+    spsc_ring(const spsc_ring&) = delete;
+    spsc_ring& operator=(const spsc_ring&) = delete;
+
+    size_t capacity() const
+    {
+        return mask_ + 1;
+    }
+
+    // producer side
+    bool try_push(const T& value)
+    {
+        const size_t head = head_.load(std::memory_order_relaxed);
+
+        if (head - tail_cache_ > mask_)
+        {
+            tail_cache_ = tail_.load(std::memory_order_acquire);
+
+            if (head - tail_cache_ > mask_)
+            {
+                return false; // full
+            }
+        }
+
+        buffer_[head & mask_] = value;
+        head_.store(head + 1, std::memory_order_release);
+        return true;
+    }
+
+    // producer side, no more values will be pushed
+    void close()
+    {
+        closed_.store(true, std::memory_order_release);
+    }
+
+    // consumer side
+    bool try_pop(T& value)
+    {
+        const size_t tail = tail_.load(std::memory_order_relaxed);
+
+        if (tail == head_cache_)
+        {
+            head_cache_ = head_.load(std::memory_order_acquire);
+
+            if (tail == head_cache_)
+            {
+                return false; // empty
+            }
+        }
+
+        value = buffer_[tail & mask_];
+        tail_.store(tail + 1, std::memory_order_release);
+        return true;
+    }
+
+    // consumer side, 'true' if the producer has closed the ring,
+    // the values pushed before close() can still be popped
+    bool is_closed() const
+    {
+        return closed_.load(std::memory_order_acquire);
+    }
+
+private:
+    static size_t round_up(size_t n)
+    {
+        DEBUG_REQUIRE(n > 0);
+        size_t r = 1;
+
+        while (r < n)
+        {
+            r <<= 1;
+        }
+
+        return r;
+    }
+
+private:
+    const size_t mask_;
+    std::vector<T> buffer_;
+
+    // written by the producer
+    alignas(constants::cache_line_size) std::atomic<size_t> head_;
+    size_t tail_cache_;
+
+    // written by the consumer
+    alignas(constants::cache_line_size) std::atomic<size_t> tail_;
+    size_t head_cache_;
+
+    alignas(constants::cache_line_size) std::atomic_bool closed_;
+};
+
+} // namespace fx
@@ -214,4 +214,9 @@ double symbol_pip(symbol sym)
     return 0.00001;
 }
 
+int symbol_digits(symbol sym)
+{
+    return (symbol_pip(sym) == 0.001) ? 3 : 5;
+}
+
 } // namespace fx
@@ -22,5 +22,6 @@ enum class symbol
 std::string symbol_to_string(symbol sym, bool uppercase = false);
 symbol symbol_from_string(const std::string& str);
 double symbol_pip(symbol sym);
+int symbol_digits(symbol sym); // number of decimal digits in the price
 
 } // namespace fx
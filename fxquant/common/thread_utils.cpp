@@ -0,0 +1,123 @@
+#if defined(_WIN32)
+#include <windows.h>
+#else
+#include <pthread.h>
+#include <sched.h>
+#endif
+#include <thread>
+#include <algorithm>
+#include "debug.h"
+#include "config.h"
+#include "thread_utils.h"
+
+using namespace std::chrono;
+
+namespace fx {
+
+wait_strategy wait_strategy_from_string(const std::string& s)
+{
+    if (s == "spin_park")
+    {
+        return wait_strategy::spin_park;
+    }
+
+    if (s == "busy_poll")
+    {
+        return wait_strategy::busy_poll;
+    }
+
+    return wait_strategy::block;
+}
+
+thread_settings get_thread_settings(const std::string& name)
+{
+    thread_settings ts;
+    ts.name = name;
+    ts.cpu = config::instance().read_int("threads", name + "_cpu", -1);
+    ts.wait = wait_strategy_from_string(config::instance().read_string("threads", name + "_wait", "block"));
+    return ts;
+}
+
+thread_settings get_thread_settings(const std::string& name, size_t index)
+{
+    thread_settings ts = get_thread_settings(name);
+    ts.name += "_" + std::to_string(index);
+
+    if (ts.cpu >= 0)
+    {
+        const size_t cores = std::max<size_t>(std::thread::hardware_concurrency(), 1);
+        ts.cpu = static_cast<int>((static_cast<size_t>(ts.cpu) + index) % cores);
+    }
+
+    return ts;
+}
+
+void apply_thread_settings(const thread_settings& settings)
+{
+    if (!settings.name.empty())
+    {
+        set_thread_name(settings.name);
+    }
+
+    if ((settings.cpu >= 0) && !set_thread_affinity(settings.cpu))
+    {
+        DEBUG_TRACE("apply_thread_settings(): cannot pin '%s' to cpu %d", settings.name.c_str(), settings.cpu);
+    }
+}
+
+bool set_thread_name(const std::string& name)
+{
+#if defined(_WIN32)
+    std::wstring wname(name.begin(), name.end());
+    return SUCCEEDED(SetThreadDescription(GetCurrentThread(), wname.c_str()));
+#else
+    // at most 15 characters
+    return pthread_setname_np(pthread_self(), name.substr(0, 15).c_str()) == 0;
+#endif
+}
+
+bool set_thread_affinity(int cpu)
+{
+    if ((cpu < 0) || (static_cast<unsigned>(cpu) >= std::thread::hardware_concurrency()))
+    {
+        return false;
+    }
+
+#if defined(_WIN32)
+    return SetThreadAffinityMask(GetCurrentThread(), DWORD_PTR(1) << cpu) != 0;
+#else
+    cpu_set_t set;
+    CPU_ZERO(&set);
+    CPU_SET(cpu, &set);
+    return pthread_setaffinity_np(pthread_self(), sizeof(set), &set) == 0;
+#endif
+}
+
+void wait_until(steady_clock::time_point t, wait_strategy wait)
+{
+    // the schedulers wake a sleeping thread up to a few hundred microseconds late
+    const auto spin_time = microseconds(200);
+
+    if (wait == wait_strategy::block)
+    {
+        std::this_thread::sleep_until(t);
+        return;
+    }
+
+    if (wait == wait_strategy::spin_park)
+    {
+        const auto now = steady_clock::now();
+
+        if (t - now > spin_time)
+        {
+            std::this_thread::sleep_until(t - spin_time);
+        }
+    }
+
+    while (steady_clock::now() < t)
+    {
+        cpu_relax();
+    }
+}
+
+} // namespace fx
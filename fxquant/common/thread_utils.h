@@ -0,0 +1,63 @@
+#pragma once
+#include <chrono>
+#include <string>
+#include "common.h"
+
+#if defined(MSVC_X86_64) || defined(GNUC_X86_64)
+#include <immintrin.h>
+#endif
+
+namespace fx {
+
+// how a thread waits for work
+enum class wait_strategy
+{
+    block,     // parks on an event right away
+    spin_park, // polls for a while, then parks
+    busy_poll  // never parks, keeps a core busy
+};
+
+// "block" (default), "spin_park" or "busy_poll"
+wait_strategy wait_strategy_from_string(const std::string& s);
+
+// a hint for the cpu that the thread is spinning
+ALWAYS_INLINE void cpu_relax()
+{
+#if defined(MSVC_X86_64) || defined(GNUC_X86_64)
+    _mm_pause();
+#endif
+}
+
+struct thread_settings
+{
+    std::string name;
+    int cpu; // -1 for any
+    wait_strategy wait;
+
+    thread_settings() : cpu(-1), wait(wait_strategy::block)
+    {
+    }
+};
+
+// reads the settings of a named thread from the "threads" config section:
+//   "<name>_cpu": the core to pin the thread to, -1 for any
+//   "<name>_wait": the wait strategy
+thread_settings get_thread_settings(const std::string& name);
+
+// the settings of the n-th of the threads sharing a name, e.g. the queue
+// threads of several engines: the thread is named "<name>_<n>" and pinned to
+// the core "<name>_cpu" + n (wrapped around the cores), so the threads do not
+// share one core
+thread_settings get_thread_settings(const std::string& name, size_t index);
+
+// names and pins the calling thread
+void apply_thread_settings(const thread_settings& settings);
+
+bool set_thread_name(const std::string& name);
+bool set_thread_affinity(int cpu);
+
+// waits until the time point, the last part of the wait is spun
+// unless the strategy is block
+void wait_until(std::chrono::steady_clock::time_point t, wait_strategy wait);
+
+} // namespace fx
@@ -0,0 +1,294 @@
+#include <cstring>
+#include <fstream>
+#include <experimental/filesystem>
+#include "tick_store.h"
+#include "tick_archive.h"
+
+namespace fs = std::experimental::filesystem;
+using namespace std::chrono;
+
+namespace {
+
+const char tick_archive_magic[8] = { 'F', 'X', 'T', 'A', 'R', 'C', 'H', '\0' };
+
+int64_t to_ms(fx::timepoint_type t)
+{
+    return duration_cast<milliseconds>(t.time_since_epoch()).count();
+}
+
+// the number of price_type units in a point of a symbol with the given digits
+int64_t point_units(int digits)
+{
+    int64_t r = fx::price_type::scale();
+
+    while ((digits-- > 0) && (r > 1))
+    {
+        r /= 10;
+    }
+
+    return r;
+}
+}
+
+namespace fx {
+
+STATIC_ASSERT(sizeof(tick_archive_file::header) == 64);
+
+// tick_encoder
+
+tick_encoder::tick_encoder(int digits, int64_t base_time_ms) :
+    point_(point_units(digits)), count_(0), time_(base_time_ms), delta_(0), bid_(0), spread_(0)
+{
+}
+
+void tick_encoder::put(const tick_data& tick)
+{
+    const int64_t time = to_ms(tick.get_time());
+    // the prices are rounded to the points of the symbol
+    const int64_t bid = (tick.get_bid_price().raw() + point_ / 2) / point_;
+    const int64_t spread = (tick.get_ask_price().raw() + point_ / 2) / point_ - bid;
+
+    const int64_t delta = time - time_;
+    put_varint(delta - delta_);
+    put_varint(bid - bid_);
+    put_varint(spread - spread_);
+
+    time_ = time;
+    delta_ = delta;
+    bid_ = bid;
+    spread_ = spread;
+    ++count_;
+}
+
+void tick_encoder::put_varint(int64_t n)
+{
+    // zig-zag, small negative numbers become small positive ones
+    uint64_t u = (static_cast<uint64_t>(n) << 1) ^ static_cast<uint64_t>(n >> 63);
+
+    while (u >= 0x80)
+    {
+        data_.push_back(static_cast<byte_t>(u | 0x80));
+        u >>= 7;
+    }
+
+    data_.push_back(static_cast<byte_t>(u));
+}
+
+// tick_decoder
+
+tick_decoder::tick_decoder() : point_(1), p_(nullptr), end_(nullptr), remaining_(0),
+    time_(0), delta_(0), bid_(0), spread_(0)
+{
+}
+
+tick_decoder::tick_decoder(int digits, int64_t base_time_ms, byte_cptr data, size_t size, size_t count) :
+    point_(point_units(digits)), p_(data), end_(data + size), remaining_(count),
+    time_(base_time_ms), delta_(0), bid_(0), spread_(0)
+{
+}
+
+// tick_archive_file
+
+tick_archive_file::tick_archive_file() : header_(nullptr)
+{
+}
+
+bool tick_archive_file::open(const std::string& path)
+{
+    close();
+
+    if (file_.open(path))
+    {
+        auto hdr = reinterpret_cast<const header*>(file_.data());
+
+        if ((file_.size() >= sizeof(header)) &&
+            (memcmp(hdr->magic, tick_archive_magic, sizeof(tick_archive_magic)) == 0) &&
+            (hdr->version == current_version) &&
+            (file_.size() == sizeof(header) + hdr->size))
+        {
+            header_ = hdr;
+            return true;
+        }
+
+        DEBUG_TRACE("tick_archive_file::open(): '%s' is not a valid archive file", path.c_str());
+        close();
+    }
+
+    return false;
+}
+
+void tick_archive_file::close()
+{
+    file_.close();
+    header_ = nullptr;
+}
+
+tick_decoder tick_archive_file::get_decoder() const
+{
+    if (!is_open())
+    {
+        return tick_decoder();
+    }
+
+    return tick_decoder(header_->digits, header_->from, file_.data() + sizeof(header),
+        static_cast<size_t>(header_->size), static_cast<size_t>(header_->count));
+}
+
+bool tick_archive_file::write(const std::string& path, symbol sym,
+    timepoint_type from, timepoint_type to, tick_source& source)
+{
+    const int digits = symbol_digits(sym);
+    tick_encoder encoder(digits, to_ms(from));
+    tick_data tick;
+
+    while (source.next(tick))
+    {
+        encoder.put(tick);
+    }
+
+    header hdr;
+    memset(&hdr, 0, sizeof(hdr));
+    memcpy(hdr.magic, tick_archive_magic, sizeof(hdr.magic));
+    hdr.version = current_version;
+    hdr.sym = static_cast<uint32_t>(sym);
+    hdr.count = encoder.size();
+    hdr.from = to_ms(from);
+    hdr.to = to_ms(to);
+    hdr.size = encoder.data().size();
+    hdr.digits = digits;
+
+    // write into a temporary file first, so a reader never maps a partial file
+    const std::string tmp_path = path + ".tmp";
+
+    { // scope
+        std::ofstream file(tmp_path, std::ios::binary | std::ios::trunc);
+
+        if (!file.is_open())
+        {
+            return false;
+        }
+
+        file.write(reinterpret_cast<const char*>(&hdr), sizeof(hdr));
+
+        if (!encoder.data().empty())
+        {
+            file.write(reinterpret_cast<const char*>(encoder.data().data()), encoder.data().size());
+        }
+
+        if (!file.good())
+        {
+            file.close();
+            fs::remove(tmp_path);
+            return false;
+        }
+    }
+
+    try
+    {
+        fs::rename(tmp_path, path);
+        return true;
+    }
+    catch (const std::exception& x)
+    {
+        DEBUG_TRACE("tick_archive_file::write(): %s", x.what());
+    }
+
+    return false;
+}
+
+// tick_archive
+
+tick_archive::tick_archive(const std::string& dir) : dir_(dir)
+{
+}
+
+std::string tick_archive::get_path(symbol sym, timepoint_type day) const
+{
+    return day_file_path(dir_, sym, day, ".fxta");
+}
+
+bool tick_archive::exists(symbol sym, timepoint_type day) const
+{
+    try
+    {
+        return fs::exists(get_path(sym, day));
+    }
+    catch (const std::exception&)
+    {
+    }
+
+    return false;
+}
+
+bool tick_archive::write(symbol sym, timepoint_type day, tick_source& source) const
+{
+    const fs::path path = get_path(sym, day);
+
+    try
+    {
+        if (!fs::exists(path.parent_path()))
+        {
+            fs::create_directories(path.parent_path());
+        }
+    }
+    catch (const std::exception& x)
+    {
+        DEBUG_TRACE("tick_archive::write(): %s", x.what());
+        return false;
+    }
+
+    const timepoint_type from = tick_store::day_start(day);
+    return tick_archive_file::write(path.string(), sym, from, from + hours(24), source);
+}
+
+// tick_archive_source
+
+tick_archive_source::tick_archive_source(const tick_archive& archive, symbol sym,
+    timepoint_type from, timepoint_type to) :
+    archive_(archive), symbol_(sym), from_(from), to_(to)
+{
+    reset();
+}
+
+void tick_archive_source::reset()
+{
+    decoder_ = tick_decoder();
+    file_.close();
+    day_ = tick_store::day_start(from_);
+}
+
+bool tick_archive_source::open_next_day()
+{
+    while (day_ < to_)
+    {
+        const timepoint_type day = day_;
+        day_ += hours(24);
+
+        // a missing file means there is no data for this day
+        if (file_.open(archive_.get_path(symbol_, day)))
+        {
+            decoder_ = file_.get_decoder();
+
+            if (day < from_)
+            {
+                // skip the ticks before the range, the decoder state is
+                // kept one tick behind so the first tick in range is not lost
+                tick_decoder d = decoder_;
+                tick_data tick;
+
+                while (d.next(tick) && (tick.get_time() < from_))
+                {
+                    decoder_ = d;
+                }
+            }
+
+            return true;
+        }
+    }
+
+    decoder_ = tick_decoder();
+    file_.close();
+    return false;
+}
+
+} // namespace fx
@@ -0,0 +1,224 @@
+#pragma once
+#include <string>
+#include <vector>
+#include "types.h"
+#include "debug.h"
+#include "common.h"
+#include "symbol.h"
+#include "mapped_file.h"
+#include "tick_source.h"
+
+namespace fx {
+
+// Compressed tick stream. Every tick is stored as three zig-zag varints:
+//   delta-of-delta of the time in milliseconds
+//   delta of the bid in points
+//   delta of the spread (ask - bid) in points
+// A typical tick takes 3-4 bytes instead of 24 bytes of tick_data.
+class tick_encoder
+{
+public:
+    tick_encoder(int digits, int64_t base_time_ms);
+
+    void put(const tick_data& tick);
+
+    const std::vector<byte_t>& data() const
+    {
+        return data_;
+    }
+
+    size_t size() const
+    {
+        return count_;
+    }
+
+private:
+    void put_varint(int64_t n);
+
+private:
+    const int64_t point_; // price_type units per point
+    std::vector<byte_t> data_;
+    size_t count_;
+
+    int64_t time_;
+    int64_t delta_;
+    int64_t bid_;
+    int64_t spread_;
+};
+
+// streaming decoder of the tick_encoder output
+class tick_decoder : public tick_source
+{
+public:
+    tick_decoder();
+    tick_decoder(int digits, int64_t base_time_ms, byte_cptr data, size_t size, size_t count);
+
+    bool next(tick_data& tick) override
+    {
+        if (remaining_ == 0)
+        {
+            return false;
+        }
+
+        --remaining_;
+        delta_ += get_varint();
+        time_ += delta_;
+        bid_ += get_varint();
+        spread_ += get_varint();
+
+        tick = tick_data(price_type::from_raw(bid_ * point_), price_type::from_raw((bid_ + spread_) * point_),
+            timepoint_type(std::chrono::milliseconds(time_)));
+        return true;
+    }
+
+    size_t size_hint() const override
+    {
+        return remaining_;
+    }
+
+private:
+    ALWAYS_INLINE int64_t get_varint()
+    {
+        uint64_t n = 0;
+        int shift = 0;
+
+        while (p_ < end_)
+        {
+            const byte_t b = *p_++;
+            n |= static_cast<uint64_t>(b & 0x7F) << shift;
+
+            if ((b & 0x80) == 0)
+            {
+                break;
+            }
+
+            shift += 7;
+        }
+
+        // zig-zag
+        return static_cast<int64_t>(n >> 1) ^ -static_cast<int64_t>(n & 1);
+    }
+
+private:
+    int64_t point_;
+    byte_cptr p_;
+    byte_cptr end_;
+    size_t remaining_;
+
+    int64_t time_;
+    int64_t delta_;
+    int64_t bid_;
+    int64_t spread_;
+};
+
+// A memory-mapped file with the compressed ticks of one symbol for one day:
+//   header
+//   byte_t data[size] - tick_encoder output
+class tick_archive_file
+{
+public:
+    struct header
+    {
+        char magic[8];
+        uint32_t version;
+        uint32_t sym;
+        uint64_t count;
+        int64_t from; // ms since epoch, inclusive
+        int64_t to;   // ms since epoch, exclusive
+        uint64_t size;
+        int32_t digits;
+        uint8_t reserved[12];
+    };
+
+    static const uint32_t current_version = 1;
+
+public:
+    tick_archive_file();
+
+    bool open(const std::string& path);
+    void close();
+
+    bool is_open() const
+    {
+        return header_ != nullptr;
+    }
+
+    size_t size() const
+    {
+        return is_open() ? static_cast<size_t>(header_->count) : 0;
+    }
+
+    // decoder of the whole file, valid while the file is open
+    tick_decoder get_decoder() const;
+
+    // writes all ticks of the source into a new file
+    static bool write(const std::string& path, symbol sym,
+        timepoint_type from, timepoint_type to, tick_source& source);
+
+private:
+    mapped_file file_;
+    const header* header_;
+};
+
+// a directory of archive files: <dir>/<symbol>/<yyyy-mm-dd>.fxta
+class tick_archive
+{
+public:
+    explicit tick_archive(const std::string& dir);
+
+    std::string get_path(symbol sym, timepoint_type day) const;
+    bool exists(symbol sym, timepoint_type day) const;
+
+    // stores the ticks of the day, an empty source creates an empty file
+    bool write(symbol sym, timepoint_type day, tick_source& source) const;
+
+private:
+    const std::string dir_;
+};
+
+// decodes the archive files for the [from, to) time range
+class tick_archive_source : public tick_source
+{
+public:
+    tick_archive_source(const tick_archive& archive, symbol sym,
+        timepoint_type from, timepoint_type to);
+
+    bool next(tick_data& tick) override
+    {
+        for ( ; ; )
+        {
+            if (decoder_.next(tick))
+            {
+                if (tick.get_time() < to_)
+                {
+                    return true;
+                }
+
+                decoder_ = tick_decoder(); // the rest of the day is out of range
+            }
+
+            if (!open_next_day())
+            {
+                return false;
+            }
+        }
+    }
+
+    // rewinds the source to the beginning of the range
+    void reset();
+
+private:
+    bool open_next_day();
+
+private:
+    const tick_archive archive_;
+    const symbol symbol_;
+    const timepoint_type from_;
+    const timepoint_type to_;
+
+    timepoint_type day_;
+    tick_archive_file file_;
+    tick_decoder decoder_;
+};
+
+} // namespace fx
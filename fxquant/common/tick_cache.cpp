@@ -0,0 +1,153 @@
+#include <string>
+#include <algorithm>
+#include <stdexcept>
+#include "debug.h"
+#include "config.h"
+#include "logger.h"
+#include "tick_cache.h"
+
+namespace fx {
+
+tick_cache::tick_cache() : bytes_(0), hits_(0), misses_(0), evictions_(0)
+{
+    const int budget_mb = config::instance().read_int("tick_cache", "budget_mb", 1024);
+    budget_ = static_cast<size_t>(std::max(budget_mb, 0)) << 20;
+}
+
+tick_source_ptr tick_cache::get(symbol sym, timepoint_type from, timepoint_type to, const loader_type& loader)
+{
+    { // scope
+        std::lock_guard<std::mutex> lock(lock_);
+
+        for (auto it = entries_.begin(); it != entries_.end(); ++it)
+        {
+            if ((it->sym == sym) && (it->from <= from) && (it->to >= to))
+            {
+                ++hits_;
+                entries_.splice(entries_.begin(), entries_, it);
+                return make_source(entries_.front(), from, to);
+            }
+        }
+
+        ++misses_;
+    }
+
+    // load without holding the lock, the other feeders may use the cache meanwhile
+    auto ticks = std::make_shared<std::vector<packed_tick>>();
+    tick_source_ptr source_ptr = loader();
+    ticks->reserve(source_ptr->size_hint());
+    tick_data td;
+
+    while (source_ptr->next(td))
+    {
+        if (!packed_tick::fits(td))
+        {
+            throw std::runtime_error("tick_cache: a tick of " + symbol_to_string(sym) + " cannot be packed");
+        }
+
+        ticks->emplace_back(td);
+    }
+
+    ticks->shrink_to_fit();
+
+    entry e;
+    e.sym = sym;
+    e.from = from;
+    e.to = to;
+    e.ticks = ticks;
+    e.bytes = ticks->capacity() * sizeof(packed_tick);
+
+    std::lock_guard<std::mutex> lock(lock_);
+
+    if (e.bytes <= budget_)
+    {
+        // the new range replaces the cached ranges it covers
+        for (auto it = entries_.begin(); it != entries_.end(); )
+        {
+            if ((it->sym == sym) && (it->from >= from) && (it->to <= to))
+            {
+                bytes_ -= it->bytes;
+                it = entries_.erase(it);
+            }
+            else
+            {
+                ++it;
+            }
+        }
+
+        bytes_ += e.bytes;
+        entries_.push_front(e);
+        evict();
+    }
+
+    return make_source(e, from, to);
+}
+
+tick_source_ptr tick_cache::make_source(const entry& e, timepoint_type from, timepoint_type to)
+{
+    const auto& ticks = *e.ticks;
+
+    auto begin = std::lower_bound(ticks.begin(), ticks.end(), packed_tick(tick_data(0, 0, from)));
+    auto end = std::lower_bound(begin, ticks.end(), packed_tick(tick_data(0, 0, to)));
+
+    return std::make_shared<tick_block_source>(e.ticks,
+        static_cast<size_t>(begin - ticks.begin()), static_cast<size_t>(end - ticks.begin()));
+}
+
+void tick_cache::evict()
+{
+    // the front entry is the one just used, it is never evicted
+    while ((bytes_ > budget_) && (entries_.size() > 1))
+    {
+        bytes_ -= entries_.back().bytes;
+        entries_.pop_back();
+        ++evictions_;
+    }
+}
+
+void tick_cache::set_budget(size_t bytes)
+{
+    std::lock_guard<std::mutex> lock(lock_);
+    budget_ = bytes;
+
+    while ((bytes_ > budget_) && !entries_.empty())
+    {
+        bytes_ -= entries_.back().bytes;
+        entries_.pop_back();
+        ++evictions_;
+    }
+}
+
+tick_cache::stats tick_cache::get_stats() const
+{
+    std::lock_guard<std::mutex> lock(lock_);
+
+    stats s;
+    s.hits = hits_;
+    s.misses = misses_;
+    s.evictions = evictions_;
+    s.entries = entries_.size();
+    s.bytes = bytes_;
+    s.budget = budget_;
+    return s;
+}
+
+void tick_cache::log_stats() const
+{
+    const stats s = get_stats();
+
+    logger::instance().info("Tick cache: hits=" + std::to_string(s.hits) +
+        " misses=" + std::to_string(s.misses) +
+        " evictions=" + std::to_string(s.evictions) +
+        " entries=" + std::to_string(s.entries) +
+        " size=" + std::to_string(s.bytes >> 20) + "MB of " + std::to_string(s.budget >> 20) + "MB");
+}
+
+void tick_cache::clear()
+{
+    std::lock_guard<std::mutex> lock(lock_);
+    entries_.clear();
+    bytes_ = 0;
+}
+
+} // namespace fx
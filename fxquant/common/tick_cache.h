@@ -0,0 +1,128 @@
+#pragma once
+#include <list>
+#include <mutex>
+#include <memory>
+#include <vector>
+#include <algorithm>
+#include <functional>
+#include "types.h"
+#include "symbol.h"
+#include "packed_tick.h"
+#include "tick_source.h"
+
+namespace fx {
+
+typedef std::shared_ptr<const std::vector<packed_tick>> tick_block_ptr;
+
+// reads a part of a shared block of ticks, the block is kept alive by the reader
+class tick_block_source : public tick_source
+{
+public:
+    tick_block_source(tick_block_ptr block, size_t begin, size_t end) :
+        block_(block), index_(begin), end_(end)
+    {
+    }
+
+    bool next(tick_data& tick) override
+    {
+        if (index_ >= end_)
+        {
+            return false;
+        }
+
+        tick = (*block_)[index_++].to_tick();
+        return true;
+    }
+
+    size_t next_block(tick_data* ticks, size_t count) override
+    {
+        const size_t n = std::min(count, end_ - index_);
+        const packed_tick* p = block_->data() + index_;
+
+        for (size_t i = 0; i < n; ++i)
+        {
+            ticks[i] = p[i].to_tick();
+        }
+
+        index_ += n;
+        return n;
+    }
+
+    size_t size_hint() const override
+    {
+        return end_ - index_;
+    }
+
+private:
+    const tick_block_ptr block_;
+    size_t index_;
+    const size_t end_;
+};
+
+// Process-wide cache of the loaded tick ranges. A request is served from any
+// cached range of the symbol which covers it, otherwise the ticks are loaded
+// and cached. The least recently used ranges are evicted when the cache
+// exceeds its byte budget, the readers of an evicted range keep their copy.
+// The ticks are kept packed, see packed_tick.
+class tick_cache // singleton
+{
+public:
+    static tick_cache& instance()
+    {
+        static tick_cache tick_cache_instance;
+        return tick_cache_instance;
+    }
+
+    // delete copy and move constructors and assign operators
+    tick_cache(tick_cache const&) = delete;
+    tick_cache(tick_cache&&) = delete;
+    tick_cache& operator=(tick_cache const&) = delete;
+    tick_cache& operator=(tick_cache &&) = delete;
+
+public:
+    struct stats
+    {
+        uint64_t hits;
+        uint64_t misses;
+        uint64_t evictions;
+        size_t entries;
+        size_t bytes;
+        size_t budget;
+    };
+
+    typedef std::function<tick_source_ptr()> loader_type;
+
+    // returns the ticks of [from, to) time range, the loader is called on a miss
+    tick_source_ptr get(symbol sym, timepoint_type from, timepoint_type to, const loader_type& loader);
+
+    void set_budget(size_t bytes);
+    stats get_stats() const;
+    void log_stats() const;
+    void clear();
+
+private:
+    tick_cache();
+
+    struct entry
+    {
+        symbol sym;
+        timepoint_type from;
+        timepoint_type to;
+        tick_block_ptr ticks;
+        size_t bytes;
+    };
+
+    static tick_source_ptr make_source(const entry& e, timepoint_type from, timepoint_type to);
+    void evict(); // must be called under the lock
+
+private:
+    mutable std::mutex lock_;
+    std::list<entry> entries_; // the most recently used first
+    size_t bytes_;
+    size_t budget_;
+    uint64_t hits_;
+    uint64_t misses_;
+    uint64_t evictions_;
+};
+
+} // namespace fx
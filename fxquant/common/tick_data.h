@@ -2,6 +2,7 @@
 #include <chrono>
 #include "types.h"
 #include "debug.h"
+#include "fixed_point.h"
 
 namespace fx {
 
@@ -12,7 +13,13 @@ public:
         timepoint_type time = std::chrono::system_clock::now()) :
         bid_(bid), ask_(ask), time_(time)
     {
-        DEBUG_ASSERT((bid_ == 0 && ask_ == 0) || (ask_ > bid_));
+        DEBUG_ASSERT((bid_.raw() == 0 && ask_.raw() == 0) || (ask_ > bid_));
+    }
+
+    tick_data(price_type bid, price_type ask, timepoint_type time) :
+        bid_(bid), ask_(ask), time_(time)
+    {
+        DEBUG_ASSERT((bid_.raw() == 0 && ask_.raw() == 0) || (ask_ > bid_));
     }
 
     double get_bid() const
@@ -25,9 +32,19 @@ public:
         return ask_;
     }
 
+    price_type get_bid_price() const
+    {
+        return bid_;
+    }
+
+    price_type get_ask_price() const
+    {
+        return ask_;
+    }
+
     double get_mid_price() const
     {
-        return bid_ + (ask_ - bid_) / 2;
+        return static_cast<double>(bid_.raw() + ask_.raw()) / (2 * price_type::scale());
     }
 
     double get_spread() const
@@ -46,8 +63,8 @@ public:
     }
 
 private:
-    double bid_;
-    double ask_;
+    price_type bid_;
+    price_type ask_;
     timepoint_type time_;
 };
 
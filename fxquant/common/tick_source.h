@@ -0,0 +1,38 @@
+#pragma once
+#include <memory>
+#include "tick_data.h"
+
+namespace fx {
+
+// a sequential source of ticks ordered by time
+struct tick_source
+{
+    // fetches the next tick, returns 'false' when there are no more ticks
+    virtual bool next(tick_data& tick) = 0;
+
+    // fetches up to 'count' ticks, returns the number of the ticks fetched,
+    // 0 when there are no more ticks
+    virtual size_t next_block(tick_data* ticks, size_t count)
+    {
+        size_t n = 0;
+
+        while ((n < count) && next(ticks[n]))
+        {
+            ++n;
+        }
+
+        return n;
+    }
+
+    // expected number of ticks, or 0 if unknown
+    virtual size_t size_hint() const
+    {
+        return 0;
+    }
+
+    virtual ~tick_source() = default;
+};
+
+typedef std::shared_ptr<tick_source> tick_source_ptr;
+
+} // namespace fx
@@ -0,0 +1,386 @@
+#include <ctime>
+#include <atomic>
+#include <vector>
+#include <cstring>
+#include <fstream>
+#include <stdexcept>
+#include <algorithm>
+#include <experimental/filesystem>
+#include "tick_store.h"
+
+namespace fs = std::experimental::filesystem;
+using namespace std::chrono;
+
+namespace {
+
+const char tick_file_magic[8] = { 'F', 'X', 'T', 'I', 'C', 'K', 'S', '\0' };
+
+// the magic as one 8-byte word; it is stored last when a file is published in
+// shared memory, so a reader which sees it also sees the rest of the header
+uint64_t magic_word()
+{
+    uint64_t w;
+    memcpy(&w, tick_file_magic, sizeof(w));
+    return w;
+}
+
+std::atomic<uint64_t>& magic_of(const fx::tick_file::header& hdr)
+{
+    STATIC_ASSERT(sizeof(std::atomic<uint64_t>) == sizeof(hdr.magic));
+    return *reinterpret_cast<std::atomic<uint64_t>*>(const_cast<char*>(hdr.magic));
+}
+
+int64_t to_ms(fx::timepoint_type t)
+{
+    return duration_cast<milliseconds>(t.time_since_epoch()).count();
+}
+
+template <typename T>
+void write_column(std::ofstream& file, const std::vector<T>& v)
+{
+    if (!v.empty())
+    {
+        file.write(reinterpret_cast<const char*>(v.data()), v.size() * sizeof(T));
+    }
+}
+
+template <typename T>
+fx::byte_ptr copy_column(fx::byte_ptr p, const std::vector<T>& v)
+{
+    if (!v.empty())
+    {
+        memcpy(p, v.data(), v.size() * sizeof(T));
+    }
+
+    return p + v.size() * sizeof(T);
+}
+
+// the columns of a tick file
+struct tick_columns
+{
+    std::vector<int64_t> times;
+    std::vector<double> bids;
+    std::vector<double> asks;
+
+    explicit tick_columns(fx::tick_source& source)
+    {
+        const size_t hint = source.size_hint();
+        times.reserve(hint);
+        bids.reserve(hint);
+        asks.reserve(hint);
+
+        fx::tick_data tick;
+
+        while (source.next(tick))
+        {
+            times.push_back(to_ms(tick.get_time()));
+            bids.push_back(tick.get_bid());
+            asks.push_back(tick.get_ask());
+        }
+    }
+
+    size_t size() const
+    {
+        return times.size();
+    }
+
+    size_t bytes() const
+    {
+        return size() * (sizeof(int64_t) + 2 * sizeof(double));
+    }
+};
+
+void make_header(fx::tick_file::header& hdr, fx::symbol sym,
+    fx::timepoint_type from, fx::timepoint_type to, size_t count)
+{
+    memset(&hdr, 0, sizeof(hdr));
+    memcpy(hdr.magic, tick_file_magic, sizeof(hdr.magic));
+    hdr.version = fx::tick_file::current_version;
+    hdr.sym = static_cast<uint32_t>(sym);
+    hdr.count = count;
+    hdr.from = to_ms(from);
+    hdr.to = to_ms(to);
+}
+}
+
+namespace fx {
+
+STATIC_ASSERT(sizeof(tick_file::header) == 64);
+
+// tick_file
+
+tick_file::tick_file() : header_(nullptr), count_(0),
+    time_(nullptr), bid_(nullptr), ask_(nullptr)
+{
+}
+
+bool tick_file::open(const std::string& path)
+{
+    close();
+
+    if (file_.open(path))
+    {
+        if (map(file_.data(), file_.size()))
+        {
+            return true;
+        }
+
+        DEBUG_TRACE("tick_file::open(): '%s' is not a valid tick file", path.c_str());
+        close();
+    }
+
+    return false;
+}
+
+bool tick_file::attach(const std::string& name)
+{
+    close();
+
+    if (shm_.open(name))
+    {
+        if (map(shm_.data(), shm_.size()))
+        {
+            return true;
+        }
+
+        DEBUG_TRACE("tick_file::attach(): '%s' is not a valid tick file", name.c_str());
+        close();
+    }
+
+    return false;
+}
+
+void tick_file::close()
+{
+    file_.close();
+    shm_.close();
+    header_ = nullptr;
+    count_ = 0;
+    time_ = nullptr;
+    bid_ = nullptr;
+    ask_ = nullptr;
+}
+
+bool tick_file::map(byte_cptr data, size_t size)
+{
+    if (size < sizeof(header))
+    {
+        return false;
+    }
+
+    auto hdr = reinterpret_cast<const header*>(data);
+
+    if ((magic_of(*hdr).load(std::memory_order_acquire) != magic_word()) ||
+        (hdr->version != current_version) ||
+        (size < sizeof(header) + hdr->count * (sizeof(int64_t) + 2 * sizeof(double))))
+    {
+        return false;
+    }
+
+    const size_t count = static_cast<size_t>(hdr->count);
+    byte_cptr p = data + sizeof(header);
+
+    header_ = hdr;
+    count_ = count;
+    time_ = reinterpret_cast<const int64_t*>(p);
+    bid_ = reinterpret_cast<const double*>(p + count * sizeof(int64_t));
+    ask_ = reinterpret_cast<const double*>(p + count * (sizeof(int64_t) + sizeof(double)));
+    return true;
+}
+
+size_t tick_file::lower_bound(timepoint_type t) const
+{
+    const int64_t ms = to_ms(t);
+    return static_cast<size_t>(std::lower_bound(time_, time_ + count_, ms) - time_);
+}
+
+bool tick_file::write(const std::string& path, symbol sym,
+    timepoint_type from, timepoint_type to, tick_source& source)
+{
+    const tick_columns columns(source);
+
+    header hdr;
+    make_header(hdr, sym, from, to, columns.size());
+
+    // write into a temporary file first, so a reader never maps a partial file
+    const std::string tmp_path = path + ".tmp";
+
+    { // scope
+        std::ofstream file(tmp_path, std::ios::binary | std::ios::trunc);
+
+        if (!file.is_open())
+        {
+            return false;
+        }
+
+        file.write(reinterpret_cast<const char*>(&hdr), sizeof(hdr));
+        write_column(file, columns.times);
+        write_column(file, columns.bids);
+        write_column(file, columns.asks);
+
+        if (!file.good())
+        {
+            file.close();
+            fs::remove(tmp_path);
+            return false;
+        }
+    }
+
+    try
+    {
+        fs::rename(tmp_path, path);
+        return true;
+    }
+    catch (const std::exception& x)
+    {
+        DEBUG_TRACE("tick_file::write(): %s", x.what());
+    }
+
+    return false;
+}
+
+std::string day_file_path(const std::string& dir, symbol sym, timepoint_type day, const char* ext)
+{
+    char date_str[16];
+    time_t t = system_clock::to_time_t(day);
+    strftime(date_str, sizeof(date_str), "%Y-%m-%d", gmtime(&t));
+
+    fs::path path = fs::path(dir) / symbol_to_string(sym) / (std::string(date_str) + ext);
+    return path.string();
+}
+
+bool tick_file::publish(shared_memory& shm, const std::string& name, symbol sym,
+    timepoint_type from, timepoint_type to, tick_source& source)
+{
+    const tick_columns columns(source);
+
+    if (!shm.create(name, sizeof(header) + columns.bytes()))
+    {
+        return false;
+    }
+
+    // the magic goes last, so a reader attached too early sees an invalid file
+    byte_ptr p = copy_column(shm.data() + sizeof(header), columns.times);
+    p = copy_column(p, columns.bids);
+    copy_column(p, columns.asks);
+
+    header hdr;
+    make_header(hdr, sym, from, to, columns.size());
+
+    auto shm_hdr = reinterpret_cast<header*>(shm.data());
+    memcpy(reinterpret_cast<char*>(shm_hdr) + sizeof(hdr.magic),
+        reinterpret_cast<const char*>(&hdr) + sizeof(hdr.magic), sizeof(hdr) - sizeof(hdr.magic));
+    magic_of(*shm_hdr).store(magic_word(), std::memory_order_release);
+    return true;
+}
+
+// tick_store
+
+tick_store::tick_store(const std::string& dir) : dir_(dir)
+{
+}
+
+std::string tick_store::get_path(symbol sym, timepoint_type day) const
+{
+    return day_file_path(dir_, sym, day, ".ticks");
+}
+
+bool tick_store::exists(symbol sym, timepoint_type day) const
+{
+    try
+    {
+        return fs::exists(get_path(sym, day));
+    }
+    catch (const std::exception&)
+    {
+    }
+
+    return false;
+}
+
+bool tick_store::write(symbol sym, timepoint_type day, tick_source& source) const
+{
+    const fs::path path = get_path(sym, day);
+
+    try
+    {
+        if (!fs::exists(path.parent_path()))
+        {
+            fs::create_directories(path.parent_path());
+        }
+    }
+    catch (const std::exception& x)
+    {
+        DEBUG_TRACE("tick_store::write(): %s", x.what());
+        return false;
+    }
+
+    const timepoint_type from = day_start(day);
+    return tick_file::write(path.string(), sym, from, from + hours(24), source);
+}
+
+timepoint_type tick_store::day_start(timepoint_type t)
+{
+    const int64_t day_secs = 24 * 60 * 60;
+    const int64_t secs = duration_cast<seconds>(t.time_since_epoch()).count();
+    return timepoint_type(seconds(secs - secs % day_secs));
+}
+
+// tick_store_source
+
+tick_store_source::tick_store_source(const tick_store& store, symbol sym,
+    timepoint_type from, timepoint_type to) :
+    store_(store), symbol_(sym), from_(from), to_(to)
+{
+    reset();
+}
+
+void tick_store_source::reset()
+{
+    file_.close();
+    day_ = tick_store::day_start(from_);
+    index_ = 0;
+    end_ = 0;
+}
+
+bool tick_store_source::open_next_day()
+{
+    while (day_ < to_)
+    {
+        const timepoint_type day = day_;
+        day_ += hours(24);
+
+        // a missing file means there is no data for this day
+        if (file_.open(store_.get_path(symbol_, day)))
+        {
+            index_ = (day < from_) ? file_.lower_bound(from_) : 0;
+            end_ = (day_ > to_) ? file_.lower_bound(to_) : file_.size();
+            return true;
+        }
+    }
+
+    file_.close();
+    return false;
+}
+
+// shared_tick_source
+
+shared_tick_source::shared_tick_source(const std::string& name,
+    timepoint_type from, timepoint_type to) :
+    from_(from), to_(to), index_(0), end_(0)
+{
+    if (!file_.attach(name))
+    {
+        throw std::runtime_error("Failed to attach to the shared tick data: " + name);
+    }
+
+    reset();
+}
+
+void shared_tick_source::reset()
+{
+    index_ = file_.lower_bound(from_);
+    end_ = file_.lower_bound(to_);
+}
+
+} // namespace fx
@@ -0,0 +1,202 @@
+#pragma once
+#include <string>
+#include "types.h"
+#include "debug.h"
+#include "symbol.h"
+#include "mapped_file.h"
+#include "shared_memory.h"
+#include "tick_source.h"
+
+namespace fx {
+
+// A memory-mapped file with the ticks of one symbol for one day.
+// Layout (native byte order, every column is 8-byte aligned):
+//   header
+//   int64_t time[count] - milliseconds since epoch
+//   double  bid[count]
+//   double  ask[count]
+class tick_file
+{
+public:
+    struct header
+    {
+        char magic[8];
+        uint32_t version;
+        uint32_t sym;
+        uint64_t count;
+        int64_t from; // ms since epoch, inclusive
+        int64_t to;   // ms since epoch, exclusive
+        uint8_t reserved[24];
+    };
+
+    static const uint32_t current_version = 1;
+
+public:
+    tick_file();
+
+    bool open(const std::string& path);
+
+    // attaches to a file published in shared memory
+    bool attach(const std::string& name);
+
+    void close();
+
+    bool is_open() const
+    {
+        return header_ != nullptr;
+    }
+
+    size_t size() const
+    {
+        return count_;
+    }
+
+    symbol get_symbol() const
+    {
+        return static_cast<symbol>(header_->sym);
+    }
+
+    int64_t get_time_ms(size_t index) const
+    {
+        DEBUG_ASSERT(index < count_);
+        return time_[index];
+    }
+
+    double get_bid(size_t index) const
+    {
+        DEBUG_ASSERT(index < count_);
+        return bid_[index];
+    }
+
+    double get_ask(size_t index) const
+    {
+        DEBUG_ASSERT(index < count_);
+        return ask_[index];
+    }
+
+    tick_data get_tick(size_t index) const
+    {
+        return tick_data(get_bid(index), get_ask(index),
+            timepoint_type(std::chrono::milliseconds(get_time_ms(index))));
+    }
+
+    // index of the first tick with time >= t
+    size_t lower_bound(timepoint_type t) const;
+
+    // writes all ticks of the source into a new file
+    static bool write(const std::string& path, symbol sym,
+        timepoint_type from, timepoint_type to, tick_source& source);
+
+    // writes all ticks of the source into a new shared memory segment, the
+    // segment stays published while 'shm' is open (POSIX: until removed)
+    static bool publish(shared_memory& shm, const std::string& name, symbol sym,
+        timepoint_type from, timepoint_type to, tick_source& source);
+
+private:
+    bool map(byte_cptr data, size_t size);
+
+private:
+    mapped_file file_;
+    shared_memory shm_;
+    const header* header_;
+    size_t count_;
+    const int64_t* time_;
+    const double* bid_;
+    const double* ask_;
+};
+
+// path of the file with the data of one symbol for one day: <dir>/<symbol>/<yyyy-mm-dd><ext>
+std::string day_file_path(const std::string& dir, symbol sym, timepoint_type day, const char* ext);
+
+// a directory of tick files: <dir>/<symbol>/<yyyy-mm-dd>.ticks
+class tick_store
+{
+public:
+    explicit tick_store(const std::string& dir);
+
+    std::string get_path(symbol sym, timepoint_type day) const;
+    bool exists(symbol sym, timepoint_type day) const;
+
+    // stores the ticks of the day, an empty source creates an empty file
+    bool write(symbol sym, timepoint_type day, tick_source& source) const;
+
+    // the beginning of the UTC day
+    static timepoint_type day_start(timepoint_type t);
+
+private:
+    const std::string dir_;
+};
+
+// walks the tick files of the store for the [from, to) time range
+class tick_store_source : public tick_source
+{
+public:
+    tick_store_source(const tick_store& store, symbol sym,
+        timepoint_type from, timepoint_type to);
+
+    bool next(tick_data& tick) override
+    {
+        while (index_ >= end_)
+        {
+            if (!open_next_day())
+            {
+                return false;
+            }
+        }
+
+        tick = file_.get_tick(index_++);
+        return true;
+    }
+
+    // rewinds the source to the beginning of the range
+    void reset();
+
+private:
+    bool open_next_day();
+
+private:
+    const tick_store store_;
+    const symbol symbol_;
+    const timepoint_type from_;
+    const timepoint_type to_;
+
+    timepoint_type day_;
+    tick_file file_;
+    size_t index_;
+    size_t end_;
+};
+
+// reads the [from, to) time range of a tick file published in shared memory
+class shared_tick_source : public tick_source
+{
+public:
+    shared_tick_source(const std::string& name, timepoint_type from, timepoint_type to);
+
+    bool next(tick_data& tick) override
+    {
+        if (index_ >= end_)
+        {
+            return false;
+        }
+
+        tick = file_.get_tick(index_++);
+        return true;
+    }
+
+    size_t size_hint() const override
+    {
+        return end_ - index_;
+    }
+
+    // rewinds the source to the beginning of the range
+    void reset();
+
+private:
+    tick_file file_;
+    const timepoint_type from_;
+    const timepoint_type to_;
+    size_t index_;
+    size_t end_;
+};
+
+} // namespace fx
@@ -2,6 +2,10 @@
 #include <chrono>
 #include "utils.h"
 
+#if defined(_WIN32)
+#define timegm _mkgmtime
+#endif
+
 namespace fx {
 const std::string time_to_string(fx::timepoint_type t)
 {
@@ -11,4 +15,20 @@ const std::string time_to_string(fx::timepoint_type t)
     return time_str;
 }
 
+time_t utc_time(int day, int month, int year)
+{
+    time_t tt;
+    time(&tt);
+    tm* ptm = gmtime(&tt);
+
+    ptm->tm_mday = day;
+    ptm->tm_mon = month - 1;
+    ptm->tm_year = year - 1900;
+    ptm->tm_hour = 0;
+    ptm->tm_min = 0;
+    ptm->tm_sec = 0;
+
+    return timegm(ptm);
+}
+
 }
\ No newline at end of file
@@ -6,6 +6,9 @@
 namespace fx {
 const std::string time_to_string(fx::timepoint_type t);
 
+// returns the beginning of the UTC day
+time_t utc_time(int day, int month, int year);
+
 template<typename Base, typename T>
 bool derived_from(const T& o)
 {
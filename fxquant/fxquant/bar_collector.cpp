@@ -25,6 +25,16 @@ void bar_collector::put_bar(timeframe_type tf, const bar_data& bar)
     }
 }
 
+void bar_collector::put_bars(timeframe_type tf, const bar_data* bars, size_t count)
+{
+    if (count > 0)
+    {
+        std::lock_guard<std::mutex> lock(lock_);
+        auto& v = bars_[tf];
+        v.insert(v.end(), bars, bars + count);
+    }
+}
+
 bool bar_collector::get_bars(timeframe_type tf, bar_array_type& bars) const
 {
     std::lock_guard<std::mutex> lock(lock_);
@@ -13,6 +13,7 @@ public:
     ~bar_collector();
 
     void put_bar(timeframe_type tf, const bar_data& bar);
+    void put_bars(timeframe_type tf, const bar_data* bars, size_t count);
 
     bool get_bars(timeframe_type tf, bar_array_type& bars) const;
     bool get_bars(timeframe_type tf, size_t start_index, size_t count, bar_array_type& bars) const;
@@ -0,0 +1,154 @@
+#include <algorithm>
+#include "debug.h"
+#include "utils.h"
+#include "close_trigger_index.h"
+
+namespace fx {
+
+namespace {
+const size_t min_compact_size = 1024;
+}
+
+close_trigger_index::close_trigger_index() : seq_(0), compact_size_(min_compact_size)
+{
+}
+
+int64_t close_trigger_index::threshold(heap_id h, const tick_data& tick)
+{
+    // the buy orders close at the bid price, the sell orders at the ask price
+    const price_type price = ((h == buy_sl) || (h == buy_tp)) ?
+        tick.get_bid_price() : tick.get_ask_price();
+    return to_key(h, price);
+}
+
+bool close_trigger_index::is_valid(heap_id h, const entry& e)
+{
+    const base_order& o = *e.optr;
+
+    if (!o.is_opened() || o.is_closed())
+    {
+        return false;
+    }
+
+    const price_type level = ((h == buy_sl) || (h == sell_sl)) ?
+        o.get_stop_loss_value() : o.get_take_profit_value();
+    return level.raw() == e.level;
+}
+
+void close_trigger_index::push(heap_id h, price_type level, const order_ptr& optr)
+{
+    if (!level.is_undefined())
+    {
+        heaps_[h].push({ to_key(h, level), seq_, level.raw(), optr });
+    }
+}
+
+void close_trigger_index::watch(order_ptr optr)
+{
+    DEBUG_REQUIRE(optr);
+
+    if (derived_from<base_buy_order>(optr))
+    {
+        push(buy_sl, optr->get_stop_loss_value(), optr);
+        push(buy_tp, optr->get_take_profit_value(), optr);
+    }
+    else
+    {
+        push(sell_sl, optr->get_stop_loss_value(), optr);
+        push(sell_tp, optr->get_take_profit_value(), optr);
+    }
+
+    seq_++;
+}
+
+void close_trigger_index::take_triggered(const tick_data& tick, order_list& triggered)
+{
+    std::vector<entry> v;
+
+    for (size_t i = 0; i < heap_count; ++i)
+    {
+        const heap_id h = heap_id(i);
+        auto& heap = heaps_[h];
+        const int64_t t = threshold(h, tick);
+
+        while (!heap.empty() && (heap.top().key <= t))
+        {
+            if (is_valid(h, heap.top()))
+            {
+                v.push_back(heap.top());
+            }
+
+            heap.pop();
+        }
+    }
+
+    if (v.size() > 1)
+    {
+        std::sort(v.begin(), v.end(), [](const entry& a, const entry& b) { return a.seq < b.seq; });
+    }
+
+    for (size_t i = 0; i < v.size(); ++i)
+    {
+        // both levels of an order may be hit by a gap
+        auto same = [&v, i](const entry& e) { return e.optr == v[i].optr; };
+
+        if (std::find_if(v.begin(), v.begin() + i, same) == v.begin() + i)
+        {
+            DEBUG_ASSERT(v[i].optr->check_close(tick));
+            triggered.push_back(v[i].optr);
+        }
+    }
+
+    if (size() >= compact_size_)
+    {
+        compact();
+    }
+}
+
+// drops the stale levels which are not hit yet
+void close_trigger_index::compact()
+{
+    for (size_t i = 0; i < heap_count; ++i)
+    {
+        const heap_id h = heap_id(i);
+        std::vector<entry> live;
+
+        while (!heaps_[h].empty())
+        {
+            if (is_valid(h, heaps_[h].top()))
+            {
+                live.push_back(heaps_[h].top());
+            }
+
+            heaps_[h].pop();
+        }
+
+        heaps_[h] = heap_type(std::less<entry>(), std::move(live));
+    }
+
+    compact_size_ = std::max(2 * size(), min_compact_size);
+}
+
+void close_trigger_index::clear()
+{
+    for (auto& heap : heaps_)
+    {
+        heap = heap_type();
+    }
+
+    compact_size_ = min_compact_size;
+}
+
+size_t close_trigger_index::size() const
+{
+    size_t n = 0;
+
+    for (const auto& heap : heaps_)
+    {
+        n += heap.size();
+    }
+
+    return n;
+}
+
+} // namespace fx
@@ -0,0 +1,76 @@
+#pragma once
+#include <list>
+#include <queue>
+#include <array>
+#include <vector>
+#include "order.h"
+
+namespace fx {
+
+// The stop loss and take profit levels of the opened orders, in four heaps:
+// the stop losses and the take profits of the buy orders (hit by the bid)
+// and of the sell orders (hit by the ask). Each heap has the level which is
+// hit first on the top, so a tick only touches the levels it hits. A level
+// stays in its heap until it is hit or found stale: the order has been
+// closed or its level has been changed since, see watch().
+class close_trigger_index
+{
+public:
+    typedef std::list<order_ptr> order_list;
+
+    close_trigger_index();
+
+    // adds the current stop loss and take profit levels of an opened order;
+    // called again after the levels of the order are changed
+    void watch(order_ptr optr);
+
+    // takes the orders which must be closed at the tick, in the order
+    // they were watched
+    void take_triggered(const tick_data& tick, order_list& triggered);
+
+    void clear();
+
+    // the number of the levels kept, including the stale ones
+    size_t size() const;
+
+private:
+    enum heap_id { buy_sl, buy_tp, sell_sl, sell_tp, heap_count };
+
+    struct entry
+    {
+        int64_t key;   // the level, negated for the heaps hit from the highest level down
+        uint64_t seq;  // the order of watch() calls
+        int64_t level; // the raw level when added
+        order_ptr optr;
+
+        // the smallest key on the top
+        bool operator<(const entry& e) const
+        {
+            return key > e.key;
+        }
+    };
+
+    typedef std::priority_queue<entry> heap_type;
+
+    static bool is_descending(heap_id h)
+    {
+        return (h == buy_sl) || (h == sell_tp);
+    }
+
+    static int64_t to_key(heap_id h, price_type price)
+    {
+        return is_descending(h) ? -price.raw() : price.raw();
+    }
+
+    static int64_t threshold(heap_id h, const tick_data& tick);
+    static bool is_valid(heap_id h, const entry& e);
+    void push(heap_id h, price_type level, const order_ptr& optr);
+    void compact();
+
+private:
+    std::array<heap_type, heap_count> heaps_;
+    uint64_t seq_;
+    size_t compact_size_; // the size which triggers the next compaction
+};
+
+} // namespace fx
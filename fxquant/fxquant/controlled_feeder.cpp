@@ -1,51 +1,21 @@
 #include <ctime>
 #include <chrono>
+#include <vector>
 #include <sstream>
 #include <iomanip>
-#include <bsoncxx/json.hpp>
-#include <bsoncxx/exception/exception.hpp>
-#include <bsoncxx/builder/basic/document.hpp>
 #include "debug.h"
+#include "utils.h"
 #include "config.h"
 #include "logger.h"
 #include "tick_data.h"
+#include "tick_cache.h"
+#include "tick_source_factory.h"
 #include "controlled_feeder.h"
 #include "gui_server.h"
 #include "fixed_point.h"
 
-#if defined(_WIN32)
-#define timegm _mkgmtime
-#endif
-
-using bsoncxx::builder::stream::document;
-using bsoncxx::builder::stream::finalize;
-using bsoncxx::builder::stream::open_array;
-using bsoncxx::builder::stream::close_array;
-using bsoncxx::builder::stream::open_document;
-using bsoncxx::builder::stream::close_document;
-using bsoncxx::builder::basic::kvp;
-
 using namespace std::chrono;
 
-namespace {
-
-time_t utc_time(int day, int month, int year)
-{
-    time_t tt;
-    time(&tt);
-    tm* ptm = gmtime(&tt);
-
-    ptm->tm_mday = day;
-    ptm->tm_mon = month - 1;
-    ptm->tm_year = year - 1900;
-    ptm->tm_hour = 0;
-    ptm->tm_min = 0;
-    ptm->tm_sec = 0;
-
-    return timegm(ptm);
-}
-}
-
 namespace fx {
 
 controlled_feeder::controlled_feeder() :
@@ -55,9 +25,13 @@ controlled_feeder::controlled_feeder() :
     , year_(config::get_int("controlled_feeder", "start_year"))
     , days_(config::get_int("controlled_feeder", "calculate_days"))
     , use_cache_(config::get_bool("controlled_feeder", "use_cache"))
+    , bars_only_(config::instance().read_bool("controlled_feeder", "bars_only", false))
+    , bar_store_dir_(config::instance().read_string("controlled_feeder", "bar_store_dir", ""))
+    , warm_start_(config::instance().read_bool("controlled_feeder", "warm_start", true))
     , lookback_minutes_(config::get_int("controlled_feeder", "lookback_minutes"))
     , speed_factor_(config::get_int("controlled_feeder", "speed_factor"))
-    , running_(false), delay_(0), bar_count_(0)
+    , thread_settings_(get_thread_settings("feeder"))
+    , running_(false), failed_(false), recording_(false), delay_(0), bar_count_(0)
 {
     if (speed_factor_ <= 0)
     {
@@ -77,6 +51,18 @@ controlled_feeder::controlled_feeder() :
 
 void controlled_feeder::sleep(const tick_data& td)
 {
+    const int d = pace(td);
+
+    if (d > 0)
+    {
+        wait_until(steady_clock::now() + milliseconds(d), thread_settings_.wait);
+    }
+}
+
+int controlled_feeder::pace(const tick_data& td)
+{
+    int d = 0;
+
     if (!is_warming_up())
     {
         const int min_delay = 20; // ms
@@ -100,14 +86,14 @@ void controlled_feeder::sleep(const tick_data& td)
 
         if (delay_ >= (min_delay * speed_factor))
         {
-            int d = static_cast<int>(delay_ / speed_factor);
-            std::this_thread::sleep_for(milliseconds(d));
+            d = static_cast<int>(delay_ / speed_factor);
             delay_ -= (d * speed_factor);
             //DEBUG_TRACE("delay=%d speed_factor=%d ds=%d", d, speed_factor, d * speed_factor);
         }
     }
 
     prev_time_ = td.get_time();
+    return d;
 }
 
 void controlled_feeder::on_bar(timeframe_type tf, const bar_data& bar)
@@ -118,63 +104,158 @@ void controlled_feeder::on_bar(timeframe_type tf, const bar_data& bar)
         //DEBUG_TRACE("bar=%d", (int)bar_count_);
     }
 
+    if (recording_)
+    {
+        recorded_bars_[tf].push_back(bar);
+    }
+
     data_feeder::on_bar(tf, bar);
 }
 
 void controlled_feeder::run()
 {
-    DEBUG_ASSERT(cursor_ptr_);
+    DEBUG_ASSERT(source_ptr_ || bar_file_.is_open());
+    apply_thread_settings(thread_settings_);
 
     try
     {
-        if (use_cache_ && !cache_.empty())
+        if (warm_source_ptr_)
         {
-            for (const auto& td : cache_)
-            {
-                if (!running_)
-                {
-                    break;
-                }
+            const size_t count = warm_up(*warm_source_ptr_);
+            warm_source_ptr_.reset();
+            logger::instance().info("Warmed up with " + std::to_string(count) + " ticks.");
+        }
 
-                on_tick(td, is_warming_up());              
-                sleep(td);
-            }
+        if (bars_only_)
+        {
+            run_bars_only();
         }
         else
         {
-            cache_.clear();
+            tick_data td;
 
-            for (auto& doc : *cursor_ptr_)
+            // the bars are counted tick by tick until the lookback period is built
+            while (running_ && is_warming_up() && source_ptr_->next(td))
             {
-                if (!running_)
-                {
-                    break;
-                }
-
-                tick_data td
-                {
-                    normalize(doc["bid"].get_double()),
-                    normalize(doc["ask"].get_double()),
-                    system_clock::time_point(doc["_id"].get_date().value)
-                };
-
-                if (use_cache_)
-                {
-                    cache_.push_back(td);
-                }
-
-                on_tick(td, is_warming_up());
+                on_tick(td, true);
                 sleep(td);
             }
+
+            std::vector<tick_data> block(tick_block_size);
+            size_t n;
+
+            while (running_ && ((n = source_ptr_->next_block(block.data(), block.size())) > 0))
+            {
+                run_block(block.data(), n);
+            }
         }
     }
+    catch (const std::exception& x)
+    {
+        logger::instance().error(std::string("The replay stopped: ") + x.what());
+        failed_ = true;
+    }
     catch (...)
     {
+        logger::instance().error("The replay stopped: unknown exception");
+        failed_ = true;
     }
 
     stop_event_.signal();
 }
 
+// passes the ticks in blocks, a block ends where the replay must be paced
+void controlled_feeder::run_block(const tick_data* ticks, size_t count)
+{
+    size_t begin = 0;
+
+    for (size_t i = 0; i < count; ++i)
+    {
+        const int d = pace(ticks[i]);
+
+        if (d > 0)
+        {
+            on_ticks(ticks + begin, i + 1 - begin);
+            begin = i + 1;
+            wait_until(steady_clock::now() + milliseconds(d), thread_settings_.wait);
+        }
+    }
+
+    on_ticks(ticks + begin, count - begin);
+}
+
+// only the bars are passed to the callbacks, at full speed; for the
+// strategies which act in on_bar() only
+void controlled_feeder::run_bars_only()
+{
+    if (bar_file_.is_open())
+    {
+        size_t count = 0;
+        const bar_data* bars = bar_file_.get_bars(feeder_timeframes[0], count);
+        on_base_bars(bars, count, bar_file_.get_next_time());
+        return;
+    }
+
+    if (!bar_store_dir_.empty())
+    {
+        recorded_bars_.clear();
+
+        for (auto tf : feeder_timeframes)
+        {
+            recorded_bars_[tf].clear();
+        }
+
+        recording_ = true;
+    }
+
+    const size_t chunk_size = 1 << 20;
+
+    std::vector<int64_t> times;
+    std::vector<double> bids;
+    times.reserve(chunk_size);
+    bids.reserve(chunk_size);
+
+    tick_data td;
+    bool more = true;
+
+    while (running_ && more)
+    {
+        times.clear();
+        bids.clear();
+
+        while ((times.size() < chunk_size) && (more = source_ptr_->next(td)))
+        {
+            times.push_back(duration_cast<milliseconds>(td.get_time().time_since_epoch()).count());
+            bids.push_back(td.get_bid());
+        }
+
+        on_ticks_bars_only(times.data(), bids.data(), times.size());
+    }
+
+    if (recording_)
+    {
+        recording_ = false;
+
+        if (!more) // the whole range has been read
+        {
+            bar_store store(bar_store_dir_);
+
+            if (!store.write(get_symbol(), from_time_, to_time_, get_source_id(),
+                get_open_bar_time(), recorded_bars_))
+            {
+                logger::instance().error("Failed to write the bar store.");
+            }
+        }
+
+        recorded_bars_.clear();
+    }
+}
+
+uint64_t controlled_feeder::get_source_id() const
+{
+    return bar_store::source_id(config::instance().read_string("controlled_feeder", "source", "mongodb"));
+}
+
 bool controlled_feeder::start()
 {
     if (running_)
@@ -184,40 +265,65 @@ bool controlled_feeder::start()
 
     try
     {
-        if (cache_.empty())
-        {
-            const std::string collection_name = symbol_to_string(get_symbol()) + "_ticks";
-            auto client = mongodb::instance().get_client();
-            auto collection = (*client)["prices-data"][collection_name];
+        const auto start_time = std::chrono::system_clock::from_time_t(utc_time(day_, month_, year_));
+        auto from_time = start_time;
+        auto to_time = start_time + hours(24 * days_);
+        warm_source_ptr_.reset();
 
-            auto from_time = std::chrono::system_clock::from_time_t(utc_time(day_, month_, year_));
+        if (lookback_minutes_ > 0)
+        {
+            if (warm_start_)
+            {
+                // the bars of the lookback period are built before the replay starts
+                auto warm_from = start_time - minutes(lookback_minutes_);
+                auto load = [this, warm_from, start_time]() {
+                    return create_tick_source("controlled_feeder", get_symbol(), warm_from, start_time); };
 
-            if (lookback_minutes_ > 0)
+                warm_source_ptr_ = use_cache_ ?
+                    tick_cache::instance().get(get_symbol(), warm_from, start_time, load) : load();
+            }
+            else
             {
+                // the lookback ticks are replayed with the tick callbacks suppressed
                 from_time -= minutes(lookback_minutes_);
+                to_time = from_time + hours(24 * days_);
             }
+        }
 
-            auto to_time = from_time + hours(24 * days_);
+        from_time_ = from_time;
+        to_time_ = to_time;
+        bar_file_.close();
 
-            auto filter = document{}
-                << "_id"
-                << open_document
-                << "$gte" << bsoncxx::types::b_date{ from_time }
-                << "$lt" << bsoncxx::types::b_date{ to_time }
-            << close_document << finalize;
+        if (bars_only_ && !bar_store_dir_.empty())
+        {
+            bar_store store(bar_store_dir_);
 
-            //auto order = document{} << "_id" << 1 << finalize;
-            auto opts = mongocxx::options::find{};
-            //opts.sort(order.view());
+            if (store.open(bar_file_, get_symbol(), from_time, to_time, get_source_id(),
+                feeder_timeframes.data(), feeder_timeframe_count))
+            {
+                logger::instance().info("Bars loaded from the bar store.");
+            }
+        }
 
-            const size_t count = static_cast<size_t>(collection.count(filter.view()));
-            cache_.reserve(count);
+        if (!bar_file_.is_open()) // the stored bars need no ticks
+        {
+            auto load = [this, from_time, to_time]() {
+                return create_tick_source("controlled_feeder", get_symbol(), from_time, to_time); };
+
+            if (use_cache_)
+            {
+                source_ptr_ = tick_cache::instance().get(get_symbol(), from_time, to_time, load);
+                tick_cache::instance().log_stats();
+            }
+            else
+            {
+                source_ptr_ = load();
+            }
 
-            auto cursor = collection.find(filter.view(), opts);
-            cursor_ptr_ = std::make_unique<mongocxx::cursor>(std::move(cursor));
-            logger::instance().info("Data loaded from DB.");
+            logger::instance().info("Data source opened.");
         }
 
+        failed_ = false;
         running_ = true;
         thread_ptr_ = std::make_unique<std::thread>(std::bind(&controlled_feeder::run, this));
 
@@ -1,10 +1,11 @@
 #pragma once
 #include <atomic>
 #include <thread>
-#include <vector>
 #include "event.h"
 #include "symbol.h"
-#include "mongodb.h"
+#include "bar_store.h"
+#include "thread_utils.h"
+#include "tick_source.h"
 #include "data_feeder.h"
 
 namespace fx {
@@ -23,13 +24,27 @@ public:
         stop_event_.wait();
     }
 
+    // true if the replay was stopped by an error, e.g. DB failed to
+    // return a chunk of ticks, rather than by the end of data
+    bool has_failed() const
+    {
+        return failed_;
+    }
+
 private:
     void run();
+    void run_bars_only();
+    void run_block(const tick_data* ticks, size_t count);
+    uint64_t get_source_id() const;
     void sleep(const tick_data& td);
+
+    // the replay delay after the tick in ms, 0 if none
+    int pace(const tick_data& td);
     
     bool is_warming_up() const
     {
-        return (lookback_minutes_ > 0) && (bar_count_ < lookback_minutes_);
+        return (lookback_minutes_ > 0) && !warm_start_ &&
+            (bar_count_ < static_cast<size_t>(lookback_minutes_));
     }
 
     virtual void on_bar(timeframe_type tf, const bar_data& bar) override;
@@ -40,15 +55,26 @@ private:
     const int year_;
     const int days_;
     const bool use_cache_;   
+    const bool bars_only_;
+    const std::string bar_store_dir_;
+    const bool warm_start_;  // the lookback bars are built in one bulk step
     int lookback_minutes_;
     int speed_factor_;
+    const thread_settings thread_settings_;
 
     std::atomic_bool running_;
+    std::atomic_bool failed_;
     std::unique_ptr<std::thread> thread_ptr_;
-    std::unique_ptr<mongocxx::cursor> cursor_ptr_;
+    tick_source_ptr source_ptr_;
+    tick_source_ptr warm_source_ptr_; // the ticks of the lookback period for the warm start
+    timepoint_type from_time_;
+    timepoint_type to_time_;
+
+    bar_file bar_file_;                   // the stored bars of the range, if any
+    bool recording_;                      // the bars are recorded for the bar store
+    bar_file::bar_map_type recorded_bars_;
 
     mutable event stop_event_;
-    std::vector<tick_data> cache_;
 
     std::atomic<int> delay_;
     timepoint_type prev_time_;
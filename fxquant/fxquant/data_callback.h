@@ -11,6 +11,25 @@ struct data_callback
     virtual void on_tick(const tick_data& tick) = 0;
     virtual void on_bar(timeframe_type tf, const bar_data& bar) = 0;
 
+    // a block of ticks in time order; no bar closes inside a block, the bars
+    // closed by the first tick are passed with on_bar() before the block
+    virtual void on_ticks(const tick_data* ticks, size_t count)
+    {
+        for (size_t i = 0; i < count; ++i)
+        {
+            on_tick(ticks[i]);
+        }
+    }
+
+    // the bars built before the start of the data, the oldest first
+    virtual void on_history(timeframe_type tf, const bar_array_type& bars)
+    {
+        for (const auto& bar : bars)
+        {
+            on_bar(tf, bar);
+        }
+    }
+
     virtual ~data_callback() = default;
 };
 
@@ -1,85 +1,99 @@
 #pragma once
+#include <memory>
 #include "types.h"
 #include "debug.h"
+#include "bar_data.h"
+#include "tick_data.h"
 #include "event_queue.h"
 #include "data_callback.h"
 
 namespace fx {
 
-class base_data_event : public base_event
+// a tick, a bar or a history event stored inline in the queue
+struct data_event
 {
-public:
-    base_data_event(data_callback_ptr cb_ptr) :
-        callback_ptr_(cb_ptr)
-    {
-    }
+    enum class type_id : uint8_t { tick, bar, history };
 
-protected:
-    const data_callback_ptr callback_ptr_;
-};
+    type_id type;
+    timeframe_type time_frame;
+    tick_data tick;
+    bar_data bar;
+    std::shared_ptr<const bar_array_type> bars; // history only
 
-class tick_event : public base_data_event
-{
-public:
-    tick_event(const tick_data& tick, data_callback_ptr cb_ptr) :
-        base_data_event(cb_ptr), tick_(tick)
+    data_event() : type(type_id::tick), time_frame(0), tick(0.0, 0.0, timepoint_type()), bar()
     {
     }
 
-    void operator ()() override
+    // only the latest of the ticks may be kept when the queue is full
+    bool is_conflatable() const
     {
-        if (callback_ptr_)
-        {
-            callback_ptr_->on_tick(tick_);
-        }
+        return type == type_id::tick;
     }
-
-private:
-    const tick_data tick_;
 };
 
-class bar_event : public base_data_event
+class data_event_queue : public event_queue<data_event>
 {
 public:
-    bar_event(timeframe_type tf, const bar_data& bar, data_callback_ptr cb_ptr) :
-        base_data_event(cb_ptr), time_frame_(tf), bar_(bar)
+    explicit data_event_queue(data_callback_ptr dcb_ptr, dispatch_mode mode = dispatch_mode::queued,
+        size_t capacity = default_capacity, overflow_policy policy = overflow_policy::block,
+        const thread_settings& settings = thread_settings()) :
+        event_queue(mode, capacity, policy, settings), dcb_ptr_(dcb_ptr)
     {
     }
 
-    void operator ()() override
+    ~data_event_queue()
     {
-        if (callback_ptr_)
-        {
-            callback_ptr_->on_bar(time_frame_, bar_);
-        }
+        stop();
+        DEBUG_TRACE("~data_event_queue()");
     }
 
-private:
-    const timeframe_type time_frame_;
-    const bar_data bar_;
-};
-
-class data_event_queue : public event_queue
-{
-public:
-    explicit data_event_queue(data_callback_ptr dcb_ptr, size_t nthreads = 1) :
-        event_queue(nthreads), dcb_ptr_(dcb_ptr)
+    bool push_tick_event(const tick_data& tick)
     {
+        data_event e;
+        e.type = data_event::type_id::tick;
+        e.tick = tick;
+        return push_event(std::move(e));
     }
 
-    ~data_event_queue()
+    bool push_bar_event(timeframe_type tf, const bar_data& bar)
     {
-        DEBUG_TRACE("~data_event_queue()");
+        data_event e;
+        e.type = data_event::type_id::bar;
+        e.time_frame = tf;
+        e.bar = bar;
+        return push_event(std::move(e));
     }
 
-    bool push_tick_event(const tick_data& tick)
+    bool push_history_event(timeframe_type tf, const bar_array_type& bars)
     {
-        return push_event(std::make_shared<tick_event>(tick, dcb_ptr_));
+        data_event e;
+        e.type = data_event::type_id::history;
+        e.time_frame = tf;
+        e.bars = std::make_shared<const bar_array_type>(bars);
+        return push_event(std::move(e));
     }
 
-    bool push_bar_event(timeframe_type tf, const bar_data& bar)
+private:
+    void execute(data_event& e) override
     {
-        return push_event(std::make_shared<bar_event>(tf, bar, dcb_ptr_));
+        if (!dcb_ptr_)
+        {
+            return;
+        }
+
+        switch (e.type)
+        {
+        case data_event::type_id::tick:
+            dcb_ptr_->on_tick(e.tick);
+            break;
+        case data_event::type_id::bar:
+            dcb_ptr_->on_bar(e.time_frame, e.bar);
+            break;
+        case data_event::type_id::history:
+            dcb_ptr_->on_history(e.time_frame, *e.bars);
+            e.bars.reset();
+            break;
+        }
     }
 
 private:
@@ -87,4 +101,3 @@ private:
 };
 
 } // namespace fx
-
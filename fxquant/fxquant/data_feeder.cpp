@@ -1,33 +1,54 @@
 #include <cmath>
 #include <chrono>
+#include <vector>
+#include "min_max.h"
 #include "data_feeder.h"
 
-using namespace std::placeholders;
-using namespace std::chrono_literals;
+using namespace std::chrono;
 
 namespace fx {
 
-data_feeder::data_feeder(symbol sym) : symbol_(sym), precision_(static_cast<int>(log10(1 / symbol_pip(sym))))
+data_feeder::data_feeder(symbol sym) : symbol_(sym), precision_(symbol_digits(sym)),
+    history_(nullptr), callbacks_(new callback_list()), generation_(0)
 {
-    // create the candle factories for all time frames
-    const timeframe_type tf_arr[] = { 1min, 5min, 15min, 30min, 1h, 4h, 168h, 720h };
+    readers_[0] = 0;
+    readers_[1] = 0;
 
-    for (auto tf : tf_arr)
+    // create the candle factories for all time frames
+    for (size_t i = 0; i < feeder_timeframe_count; ++i)
     {
-        candle_factories_.insert({ tf, candle_factory(tf,
-            std::bind(&data_feeder::on_bar, this, tf, _1)) });
+        DEBUG_ENSURE(feeder_timeframes[i].count() % feeder_timeframes[0].count() == 0);
+        candle_factories_[i] = candle_factory(feeder_timeframes[i]);
     }
 
     DEBUG_ENSURE((precision_ == 5) || (precision_ == 3));
 }
 
+data_feeder::~data_feeder()
+{
+    delete callbacks_.load();
+}
+
 bool data_feeder::add_callback(data_callback_ptr cb_ptr)
 {
     if (cb_ptr)
     {
         std::lock_guard<std::mutex> lock(lock_);
-        auto r = callbacks_.insert(cb_ptr);
-        return r.second;
+        const callback_list* current = callbacks_.load();
+
+        for (auto p : current->owners)
+        {
+            if (p == cb_ptr)
+            {
+                return false;
+            }
+        }
+
+        auto list = new callback_list(*current);
+        list->owners.push_back(cb_ptr);
+        list->callbacks.push_back(cb_ptr.get());
+        publish(list);
+        return true;
     }
 
     return false;
@@ -38,49 +59,221 @@ bool data_feeder::remove_callback(data_callback_ptr cb_ptr)
     if (cb_ptr)
     {
         std::lock_guard<std::mutex> lock(lock_);
-        auto it = callbacks_.find(cb_ptr);
+        const callback_list* current = callbacks_.load();
 
-        if (it != callbacks_.end())
+        for (size_t i = 0; i < current->owners.size(); ++i)
         {
-            callbacks_.erase(it);
-            return true;
+            if (current->owners[i] == cb_ptr)
+            {
+                auto list = new callback_list(*current);
+                list->owners.erase(list->owners.begin() + i);
+                list->callbacks.erase(list->callbacks.begin() + i);
+                publish(list);
+                return true;
+            }
         }
     }
 
     return false;
 }
 
+void data_feeder::publish(callback_list* list)
+{
+    const callback_list* old = callbacks_.exchange(list);
+
+    // the readers which start from now on see the new list, so only the
+    // ones counted in the previous generation may still use the old list
+    const unsigned g = generation_.fetch_add(1) & 1;
+
+    while (readers_[g].load() > 0)
+    {
+        std::this_thread::yield();
+    }
+
+    delete old;
+}
+
 void data_feeder::on_tick(const tick_data& tick, bool ignore_callback)
 {
-    for (auto& fac : candle_factories_)
+    const time_t t = system_clock::to_time_t(tick.get_time());
+    const price_type bid = tick.get_bid_price();
+    bar_data bar;
+
+    // only the base time frame sees the ticks, the higher time frames
+    // are rolled up from its closed bars
+    if (candle_factories_[0].put_tick(t, bid, bar))
     {
-        fac.second.put_tick(tick);
+        on_base_bar(bar, candle_factories_[0].get_bar_time());
     }
 
     if (!ignore_callback)
     {
-        std::lock_guard<std::mutex> lock(lock_);
+        for_each_callback([&tick](data_callback* cb) { cb->on_tick(tick); });
+    }
+}
+
+void data_feeder::on_ticks(const tick_data* ticks, size_t count, bool ignore_callback)
+{
+    size_t begin = 0;
+    bar_data bar;
 
-        for (auto cb_ptr : callbacks_)
+    for (size_t i = 0; i < count; ++i)
+    {
+        const time_t t = system_clock::to_time_t(ticks[i].get_time());
+
+        if (candle_factories_[0].put_tick(t, ticks[i].get_bid_price(), bar))
         {
-            cb_ptr->on_tick(tick);
+            // the ticks before the closing one go first, then the closed bars
+            if (!ignore_callback)
+            {
+                put_ticks(ticks + begin, i - begin);
+            }
+
+            begin = i;
+            on_base_bar(bar, candle_factories_[0].get_bar_time());
         }
     }
+
+    if (!ignore_callback)
+    {
+        put_ticks(ticks + begin, count - begin);
+    }
 }
 
-void data_feeder::on_bar(timeframe_type tf, const bar_data& bar)
+void data_feeder::put_ticks(const tick_data* ticks, size_t count)
+{
+    if (count > 0)
+    {
+        for_each_callback([ticks, count](data_callback* cb) { cb->on_ticks(ticks, count); });
+    }
+}
+
+void data_feeder::on_ticks_bars_only(const int64_t* time_ms, const double* bid, size_t count)
 {
-    std::lock_guard<std::mutex> lock(lock_);
+    const int64_t bucket_ms = duration_cast<milliseconds>(feeder_timeframes[0]).count();
+    size_t i = 0;
 
-    for (auto cb_ptr : callbacks_)
+    while (i < count)
     {
-        cb_ptr->on_bar(tf, bar);
+        // the ticks of one base bar
+        const int64_t bucket_end = (time_ms[i] / bucket_ms + 1) * bucket_ms;
+        size_t end = i + 1;
+
+        while ((end < count) && (time_ms[end] < bucket_end))
+        {
+            ++end;
+        }
+
+        double low;
+        double high;
+        min_max(bid + i, end - i, low, high);
+
+        bar_data bar;
+
+        if (candle_factories_[0].put_ticks(static_cast<time_t>(time_ms[i] / 1000), price_type(bid[i]),
+            price_type(high), price_type(low), price_type(bid[end - 1]), bar))
+        {
+            on_base_bar(bar, candle_factories_[0].get_bar_time());
+        }
+
+        i = end;
     }
 }
 
+void data_feeder::on_base_bars(const bar_data* bars, size_t count, time_t next_time)
+{
+    for (size_t i = 0; i < count; ++i)
+    {
+        on_base_bar(bars[i], (i + 1 < count) ? bars[i + 1].t : next_time);
+    }
+}
+
+void data_feeder::on_base_bar(const bar_data& bar, time_t next_time)
+{
+    bar_data higher_bar;
+
+    if (history_)
+    {
+        (*history_)[0].push_back(bar);
+
+        for (size_t i = 1; i < feeder_timeframe_count; ++i)
+        {
+            if (candle_factories_[i].put_bar(bar, next_time, higher_bar))
+            {
+                (*history_)[i].push_back(higher_bar);
+            }
+        }
+
+        return;
+    }
+
+    on_bar(feeder_timeframes[0], bar);
+
+    for (size_t i = 1; i < feeder_timeframe_count; ++i)
+    {
+        if (candle_factories_[i].put_bar(bar, next_time, higher_bar))
+        {
+            on_bar(feeder_timeframes[i], higher_bar);
+        }
+    }
+}
+
+size_t data_feeder::warm_up(tick_source& source)
+{
+    const size_t chunk_size = 1 << 20;
+
+    std::array<bar_array_type, feeder_timeframe_count> history;
+    std::vector<int64_t> times;
+    std::vector<double> bids;
+    times.reserve(chunk_size);
+    bids.reserve(chunk_size);
+
+    size_t count = 0;
+    tick_data td;
+    bool more = true;
+    history_ = &history;
+
+    try
+    {
+        while (more)
+        {
+            times.clear();
+            bids.clear();
+
+            while ((times.size() < chunk_size) && (more = source.next(td)))
+            {
+                times.push_back(duration_cast<milliseconds>(td.get_time().time_since_epoch()).count());
+                bids.push_back(td.get_bid());
+            }
+
+            on_ticks_bars_only(times.data(), bids.data(), times.size());
+            count += times.size();
+        }
+    }
+    catch (...)
+    {
+        history_ = nullptr;
+        throw;
+    }
+
+    history_ = nullptr;
+
+    for (size_t i = 0; i < feeder_timeframe_count; ++i)
+    {
+        for_each_callback([&history, i](data_callback* cb) { cb->on_history(feeder_timeframes[i], history[i]); });
+    }
+
+    return count;
+}
+
+void data_feeder::on_bar(timeframe_type tf, const bar_data& bar)
+{
+    for_each_callback([tf, &bar](data_callback* cb) { cb->on_bar(tf, bar); });
+}
+
 double data_feeder::normalize(double d) const
 {
-    return (precision_ == 5) ? (double)fixed_point<5>(d) : (double)fixed_point<3>(d);
+    return normalize_price(d, precision_);
 }
 
 } // namespace fx
\ No newline at end of file
@@ -1,22 +1,33 @@
 #pragma once
-#include <set>
-#include <map>
+#include <array>
 #include <mutex>
+#include <atomic>
 #include <memory>
+#include <thread>
 #include <vector>
 #include "types.h"
 #include "symbol.h"
 #include "fixed_point.h"
 #include "data_callback.h"
+#include "tick_source.h"
 #include "candle_factory.h"
 
 namespace fx {
 
+// the time frames of the bars built by every feeder
+constexpr size_t feeder_timeframe_count = 8;
+
+constexpr std::array<timeframe_type, feeder_timeframe_count> feeder_timeframes =
+{{
+    timeframe_type(1), timeframe_type(5), timeframe_type(15), timeframe_type(30),
+    timeframe_type(60), timeframe_type(240), timeframe_type(168 * 60), timeframe_type(720 * 60)
+}};
+
 class data_feeder // a base class for all feeders
 {
 public:
     explicit data_feeder(symbol sym);
-    virtual ~data_feeder() = default;
+    virtual ~data_feeder();
 
     virtual bool start() = 0;
     virtual bool stop() = 0;
@@ -26,6 +37,8 @@ public:
         return symbol_;
     }
 
+    // safe while the feeder is running; a removed callback is not called
+    // any more once remove_callback() returns
     bool add_callback(data_callback_ptr cb_ptr);
     bool remove_callback(data_callback_ptr cb_ptr);
 
@@ -33,14 +46,107 @@ public:
 
 protected:
     void on_tick(const tick_data& tick, bool ignore_callback = false);
+
+    // the same as on_tick() for each of the ticks, the callbacks get the ticks
+    // in blocks split at the bar boundaries, see data_callback::on_ticks()
+    void on_ticks(const tick_data* ticks, size_t count, bool ignore_callback = false);
+
     virtual void on_bar(timeframe_type tf, const bar_data& bar);
 
+    // the number of the ticks a feeder reads from its source at once
+    static const size_t tick_block_size = 4096;
+
+    // builds the bars of the ticks before the start in one bulk step and passes them
+    // to the callbacks with on_history(), the candle factories keep the open bars;
+    // returns the number of ticks
+    size_t warm_up(tick_source& source);
+
+    // builds the bars from a sorted array of ticks given as the time (ms since epoch)
+    // and the bid columns, the tick callbacks are not called; the bars are the same
+    // as if the ticks were passed to on_tick() one by one
+    void on_ticks_bars_only(const int64_t* time_ms, const double* bid, size_t count);
+
+    // replays the closed bars of the base time frame (the first of feeder_timeframes)
+    // with the higher time frames rolled up from them, 'next_time' is the open time
+    // of the bar which follows the last one
+    void on_base_bars(const bar_data* bars, size_t count, time_t next_time);
+
+    // the open time of the current base bar, 0 if there is none
+    time_t get_open_bar_time() const
+    {
+        return candle_factories_[0].get_bar_time();
+    }
+
+    // calls f(data_callback*) for every callback without locking
+    template <typename F>
+    void for_each_callback(F f) const
+    {
+        reader_guard guard(*this);
+
+        for (auto cb : guard.list->callbacks)
+        {
+            f(cb);
+        }
+    }
+
+private:
+    // an immutable snapshot of the callbacks, replaced as a whole on a change
+    struct callback_list
+    {
+        std::vector<data_callback_ptr> owners;
+        std::vector<data_callback*> callbacks;
+    };
+
+    // a reader of the snapshot; the readers are counted per generation, so
+    // a writer only waits for the readers which may still see the old snapshot.
+    // A reader is counted in the generation it has read only if the generation
+    // is still current after the increment, otherwise a writer which flipped it
+    // meanwhile would not wait for the reader
+    struct reader_guard
+    {
+        explicit reader_guard(const data_feeder& f)
+        {
+            for ( ; ; )
+            {
+                const unsigned g = f.generation_.load();
+                readers = &f.readers_[g & 1];
+                readers->fetch_add(1);
+
+                if (f.generation_.load() == g)
+                {
+                    break;
+                }
+
+                readers->fetch_sub(1, std::memory_order_release); // retry in the new generation
+            }
+
+            list = f.callbacks_.load();
+        }
+
+        ~reader_guard()
+        {
+            readers->fetch_sub(1, std::memory_order_release);
+        }
+
+        std::atomic<int>* readers;
+        const callback_list* list;
+    };
+
+    void on_base_bar(const bar_data& bar, time_t next_time);
+    void put_ticks(const tick_data* ticks, size_t count);
+    void publish(callback_list* list);
+
 protected:
     const symbol symbol_;
     const int precision_;
-    mutable std::mutex lock_;
-    std::set<data_callback_ptr> callbacks_;
-    std::map<timeframe_type, candle_factory> candle_factories_;
+    std::mutex lock_; // serializes the changes of the callbacks
+    std::array<candle_factory, feeder_timeframe_count> candle_factories_;
+    std::array<bar_array_type, feeder_timeframe_count>* history_; // not null while warming up
+
+private:
+    std::atomic<const callback_list*> callbacks_;
+    mutable std::atomic<unsigned> generation_;
+    mutable std::atomic<int> readers_[2];
 };
 
 typedef std::shared_ptr<data_feeder> data_feeder_ptr;
@@ -0,0 +1,205 @@
+#include <map>
+#include <vector>
+#include <bsoncxx/builder/basic/kvp.hpp>
+#include <bsoncxx/builder/basic/document.hpp>
+#include <bsoncxx/builder/stream/document.hpp>
+#include "debug.h"
+#include "utils.h"
+#include "logger.h"
+#include "fixed_point.h"
+#include "tick_store.h"
+#include "db_tick_source.h"
+#include "db_bucket_source.h"
+
+using bsoncxx::builder::stream::document;
+using bsoncxx::builder::stream::finalize;
+using bsoncxx::builder::stream::open_document;
+using bsoncxx::builder::stream::close_document;
+using bsoncxx::builder::basic::kvp;
+using bsoncxx::builder::basic::sub_array;
+
+using namespace std::chrono;
+
+namespace {
+
+const std::string db_name = "prices-data";
+
+std::string bucket_collection_name(fx::symbol sym)
+{
+    return fx::symbol_to_string(sym) + "_ticks_1m";
+}
+
+int64_t to_ms(fx::timepoint_type t)
+{
+    return duration_cast<milliseconds>(t.time_since_epoch()).count();
+}
+
+fx::timepoint_type minute_start(fx::timepoint_type t)
+{
+    const int64_t ms = to_ms(t);
+    return fx::timepoint_type(milliseconds(ms - ms % 60000));
+}
+
+bsoncxx::document::value make_range_filter(int64_t from_ms, int64_t to_ms)
+{
+    return document{}
+        << "_id"
+        << open_document
+        << "$gte" << bsoncxx::types::b_date{ milliseconds(from_ms) }
+        << "$lt" << bsoncxx::types::b_date{ milliseconds(to_ms) }
+    << close_document << finalize;
+}
+}
+
+namespace fx {
+
+db_bucket_source::db_bucket_source(symbol sym, timepoint_type from, timepoint_type to, int batch_size) :
+    digits_(symbol_digits(sym)), from_(from), to_(to),
+    client_(mongodb::instance().get_client()), index_(0)
+{
+    auto collection = (*client_)[db_name][bucket_collection_name(sym)];
+
+    // the bucket of the first minute may hold the ticks before 'from', they are skipped
+    auto filter = make_range_filter(to_ms(minute_start(from)), to_ms(to));
+
+    auto opts = mongocxx::options::find{};
+
+    if (batch_size > 0)
+    {
+        opts.batch_size(batch_size);
+    }
+
+    cursor_ptr_ = std::make_unique<mongocxx::cursor>(collection.find(filter.view(), opts));
+    it_ptr_ = std::make_unique<mongocxx::cursor::iterator>(cursor_ptr_->begin());
+}
+
+bool db_bucket_source::next_bucket()
+{
+    ticks_.clear();
+    index_ = 0;
+
+    auto& it = *it_ptr_;
+
+    while (ticks_.empty())
+    {
+        if (it == cursor_ptr_->end())
+        {
+            return false;
+        }
+
+        const auto& doc = *it;
+        const int64_t minute_ms = doc["_id"].get_date().value.count();
+
+        auto t = doc["t"].get_array().value;
+        auto b = doc["b"].get_array().value;
+        auto a = doc["a"].get_array().value;
+
+        auto t_it = t.begin();
+        auto b_it = b.begin();
+        auto a_it = a.begin();
+
+        for ( ; (t_it != t.end()) && (b_it != b.end()) && (a_it != a.end()); ++t_it, ++b_it, ++a_it)
+        {
+            const timepoint_type time(milliseconds(minute_ms + (*t_it).get_int32().value));
+
+            if ((time >= from_) && (time < to_))
+            {
+                ticks_.emplace_back(
+                    normalize_price((*b_it).get_double(), digits_),
+                    normalize_price((*a_it).get_double(), digits_),
+                    time);
+            }
+        }
+
+        ++it;
+    }
+
+    return true;
+}
+
+bool migrate_ticks_to_buckets(symbol sym, timepoint_type from, timepoint_type to)
+{
+    try
+    {
+        auto client = mongodb::instance().get_client();
+        auto collection = (*client)[db_name][bucket_collection_name(sym)];
+
+        // whole minutes only, so every bucket is rewritten with all its ticks
+        from = minute_start(from);
+        to = minute_start(to + minutes(1) - milliseconds(1));
+
+        for (auto day = tick_store::day_start(from); day < to; day += hours(24))
+        {
+            const timepoint_type day_from = std::max(day, from);
+            const timepoint_type day_to = std::min<timepoint_type>(day + hours(24), to);
+
+            // the ticks of every minute of the day
+            std::map<int64_t, std::vector<tick_data>> buckets;
+            db_tick_source source(sym, day_from, day_to);
+            tick_data td;
+            size_t count = 0;
+
+            while (source.next(td))
+            {
+                const int64_t ms = to_ms(td.get_time());
+                buckets[ms - ms % 60000].push_back(td);
+                ++count;
+            }
+
+            std::vector<bsoncxx::document::value> docs;
+            docs.reserve(buckets.size());
+
+            for (const auto& m : buckets)
+            {
+                const int64_t minute_ms = m.first;
+                const auto& ticks = m.second;
+
+                bsoncxx::builder::basic::document doc;
+                doc.append(
+                    kvp("_id", bsoncxx::types::b_date{ milliseconds(minute_ms) }),
+                    kvp("t", [&ticks, minute_ms](sub_array arr) {
+                        for (const auto& tick : ticks)
+                        {
+                            arr.append(static_cast<int32_t>(to_ms(tick.get_time()) - minute_ms));
+                        }
+                    }),
+                    kvp("b", [&ticks](sub_array arr) {
+                        for (const auto& tick : ticks)
+                        {
+                            arr.append(tick.get_bid());
+                        }
+                    }),
+                    kvp("a", [&ticks](sub_array arr) {
+                        for (const auto& tick : ticks)
+                        {
+                            arr.append(tick.get_ask());
+                        }
+                    }));
+
+                docs.push_back(doc.extract());
+            }
+
+            auto filter = make_range_filter(to_ms(day_from), to_ms(day_to));
+            collection.delete_many(filter.view());
+
+            if (!docs.empty())
+            {
+                collection.insert_many(docs);
+            }
+
+            logger::instance().info("Migrated " + std::to_string(count) + " ticks into " +
+                std::to_string(docs.size()) + " buckets: " + time_to_string(day_from));
+        }
+
+        return true;
+    }
+    catch (const std::exception& x)
+    {
+        DEBUG_TRACE("migrate_ticks_to_buckets(): %s", x.what());
+        logger::instance().error(std::string("Tick migration failed: ") + x.what());
+    }
+
+    return false;
+}
+
+} // namespace fx
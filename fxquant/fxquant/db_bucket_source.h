@@ -0,0 +1,54 @@
+#pragma once
+#include <memory>
+#include <vector>
+#include "types.h"
+#include "symbol.h"
+#include "mongodb.h"
+#include "tick_source.h"
+
+namespace fx {
+
+// Reads the ticks of [from, to) time range from the '<symbol>_ticks_1m'
+// collection, which keeps one document per minute:
+//   { _id: <minute>, t: [ms offsets in the minute], b: [bids], a: [asks] }
+class db_bucket_source : public tick_source
+{
+public:
+    db_bucket_source(symbol sym, timepoint_type from, timepoint_type to, int batch_size = 0);
+
+    bool next(tick_data& tick) override
+    {
+        while (index_ >= ticks_.size())
+        {
+            if (!next_bucket())
+            {
+                return false;
+            }
+        }
+
+        tick = ticks_[index_++];
+        return true;
+    }
+
+private:
+    bool next_bucket();
+
+private:
+    const int digits_;
+    const timepoint_type from_;
+    const timepoint_type to_;
+    mongodb::client_type client_; // must outlive the cursor
+    std::unique_ptr<mongocxx::cursor> cursor_ptr_;
+    std::unique_ptr<mongocxx::cursor::iterator> it_ptr_;
+
+    std::vector<tick_data> ticks_; // the ticks of the current bucket
+    size_t index_;
+};
+
+// Rewrites the ticks of [from, to) time range from the per tick '<symbol>_ticks'
+// collection into the '<symbol>_ticks_1m' bucket collection. The range is
+// processed by days, the buckets of a day are replaced as a whole, so the
+// migration can be restarted. The source collection is not modified.
+bool migrate_ticks_to_buckets(symbol sym, timepoint_type from, timepoint_type to);
+
+} // namespace fx
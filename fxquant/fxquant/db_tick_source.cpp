@@ -0,0 +1,389 @@
+#include <algorithm>
+#include <stdexcept>
+#include <bsoncxx/builder/stream/document.hpp>
+#include "debug.h"
+#include "logger.h"
+#include "fixed_point.h"
+#include "db_tick_source.h"
+
+using bsoncxx::builder::stream::document;
+using bsoncxx::builder::stream::finalize;
+using bsoncxx::builder::stream::open_document;
+using bsoncxx::builder::stream::close_document;
+
+using namespace std::chrono;
+
+namespace {
+
+// waits for the other side of the ring
+void backoff(unsigned n)
+{
+    if (n < 64)
+    {
+        return; // spin
+    }
+
+    if (n < 128)
+    {
+        std::this_thread::yield();
+    }
+    else
+    {
+        std::this_thread::sleep_for(microseconds(100));
+    }
+}
+}
+
+namespace fx {
+
+db_tick_source::db_tick_source(symbol sym, timepoint_type from, timepoint_type to, int batch_size) :
+    digits_(symbol_digits(sym)), client_(mongodb::instance().get_client()),
+    ring_(ring_capacity), shutdown_(false)
+{
+    const std::string collection_name = symbol_to_string(sym) + "_ticks";
+    auto collection = (*client_)["prices-data"][collection_name];
+
+    auto filter = document{}
+        << "_id"
+        << open_document
+        << "$gte" << bsoncxx::types::b_date{ from }
+        << "$lt" << bsoncxx::types::b_date{ to }
+    << close_document << finalize;
+
+    auto projection = document{}
+        << "_id" << 1
+        << "bid" << 1
+        << "ask" << 1
+    << finalize;
+
+    auto opts = mongocxx::options::find{};
+    opts.projection(projection.view());
+
+    if (batch_size > 0)
+    {
+        opts.batch_size(batch_size);
+    }
+
+    cursor_ptr_ = std::make_unique<mongocxx::cursor>(collection.find(filter.view(), opts));
+    thread_ = std::thread(std::bind(&db_tick_source::reader_func, this));
+}
+
+db_tick_source::~db_tick_source()
+{
+    shutdown_ = true;
+
+    if (thread_.joinable())
+    {
+        thread_.join();
+    }
+}
+
+bool db_tick_source::wait_next(tick_data& tick)
+{
+    for (unsigned n = 0; ; n++)
+    {
+        // check the flag first, the ticks pushed before close() are still in the ring
+        const bool closed = ring_.is_closed();
+
+        if (ring_.try_pop(tick))
+        {
+            return true;
+        }
+
+        if (closed)
+        {
+            if (error_)
+            {
+                std::rethrow_exception(error_);
+            }
+
+            return false;
+        }
+
+        backoff(n);
+    }
+}
+
+void db_tick_source::reader_func()
+{
+    size_t skipped = 0;
+
+    try
+    {
+        for (const auto& doc : *cursor_ptr_)
+        {
+            double bid = 0.0;
+            double ask = 0.0;
+            int64_t time_ms = 0;
+            unsigned fields = 0; // one bit per field found
+
+            // a single pass over the projected fields instead of a lookup per field
+            for (const auto& field : doc)
+            {
+                const auto key = field.key();
+
+                if (key == "_id")
+                {
+                    time_ms = field.get_date().value.count();
+                    fields |= 1;
+                }
+                else if (key == "bid")
+                {
+                    bid = field.get_double();
+                    fields |= 2;
+                }
+                else if (key == "ask")
+                {
+                    ask = field.get_double();
+                    fields |= 4;
+                }
+            }
+
+            if (fields != 7)
+            {
+                // a tick of 0 would corrupt the bars and hit every stop loss
+                DEBUG_TRACE("db_tick_source::reader_func(): incomplete document at %lld ms",
+                    static_cast<long long>(time_ms));
+                skipped++;
+                continue;
+            }
+
+            const tick_data tick
+            {
+                normalize_price(bid, digits_),
+                normalize_price(ask, digits_),
+                system_clock::time_point(milliseconds(time_ms))
+            };
+
+            for (unsigned n = 0; !ring_.try_push(tick); n++)
+            {
+                if (shutdown_)
+                {
+                    ring_.close();
+                    return;
+                }
+
+                backoff(n);
+            }
+
+            if (shutdown_)
+            {
+                break;
+            }
+        }
+    }
+    catch (const std::exception& x)
+    {
+        DEBUG_TRACE("db_tick_source::reader_func(): %s", x.what());
+        error_ = std::current_exception();
+    }
+
+    if (skipped > 0)
+    {
+        logger::instance().warning("Skipped " + std::to_string(skipped) +
+            " tick documents without the time, bid or ask.");
+    }
+
+    ring_.close();
+}
+
+// chunked_db_tick_source
+
+chunked_db_tick_source::chunked_db_tick_source(symbol sym, timepoint_type from, timepoint_type to,
+    size_t nthreads, std::chrono::hours chunk_size, int batch_size) :
+    symbol_(sym), batch_size_(batch_size), window_(2 * nthreads), fetch_index_(0), read_index_(0),
+    ticks_(nullptr), index_(0), count_(0), shutdown_(false)
+{
+    DEBUG_REQUIRE(nthreads > 0);
+    DEBUG_REQUIRE(chunk_size.count() > 0);
+
+    for (auto t = from; t < to; t += chunk_size)
+    {
+        chunk c;
+        c.from = t;
+        c.to = std::min<timepoint_type>(t + chunk_size, to);
+        c.ready = false;
+        c.failed = false;
+        chunks_.push_back(std::move(c));
+    }
+
+    nthreads = std::min(nthreads, chunks_.size());
+
+    for (size_t i = 0; i < nthreads; i++)
+    {
+        workers_.emplace_back(std::bind(&chunked_db_tick_source::worker_func, this));
+    }
+}
+
+chunked_db_tick_source::~chunked_db_tick_source()
+{
+    { // scope
+        std::lock_guard<std::mutex> lock(lock_);
+        shutdown_ = true;
+    }
+
+    space_cond_.notify_all();
+
+    for (auto& t : workers_)
+    {
+        t.join();
+    }
+}
+
+bool chunked_db_tick_source::next_chunk()
+{
+    std::unique_lock<std::mutex> lock(lock_);
+
+    if (ticks_)
+    {
+        // release the chunk which has been read
+        std::vector<tick_data>().swap(chunks_[read_index_++].ticks);
+        ticks_ = nullptr;
+        index_ = 0;
+        count_ = 0;
+        space_cond_.notify_all();
+    }
+
+    if (read_index_ >= chunks_.size())
+    {
+        return false; // done
+    }
+
+    const chunk& c = chunks_[read_index_];
+    ready_cond_.wait(lock, [&c]() { return c.ready; });
+
+    if (c.failed)
+    {
+        throw std::runtime_error("Failed to fetch ticks from DB.");
+    }
+
+    ticks_ = &c.ticks;
+    count_ = c.ticks.size();
+    return true;
+}
+
+void chunked_db_tick_source::worker_func()
+{
+    for ( ; ; )
+    {
+        size_t n = 0;
+
+        { // scope
+            std::unique_lock<std::mutex> lock(lock_);
+
+            space_cond_.wait(lock, [this]() {
+                return shutdown_ || (fetch_index_ >= chunks_.size()) ||
+                    (fetch_index_ < read_index_ + window_); });
+
+            if (shutdown_ || (fetch_index_ >= chunks_.size()))
+            {
+                break;
+            }
+
+            n = fetch_index_++;
+        }
+
+        std::vector<tick_data> ticks;
+        bool failed = false;
+
+        try
+        {
+            db_tick_source source(symbol_, chunks_[n].from, chunks_[n].to, batch_size_);
+            tick_data td;
+
+            while (!shutdown_ && source.next(td))
+            {
+                ticks.push_back(td);
+            }
+        }
+        catch (const std::exception& x)
+        {
+            DEBUG_TRACE("chunked_db_tick_source::worker_func(): %s", x.what());
+            failed = true;
+        }
+
+        { // scope
+            std::lock_guard<std::mutex> lock(lock_);
+            chunks_[n].ticks.swap(ticks);
+            chunks_[n].failed = failed;
+            chunks_[n].ready = true;
+        }
+
+        ready_cond_.notify_all();
+    }
+}
+
+// the time of the latest tick of the symbol in DB, the epoch if there is none
+static timepoint_type last_db_tick_time(symbol sym)
+{
+    auto client = mongodb::instance().get_client();
+    auto collection = (*client)["prices-data"][symbol_to_string(sym) + "_ticks"];
+
+    auto filter = document{} << finalize;
+    auto order = document{} << "_id" << -1 << finalize;
+    auto projection = document{} << "_id" << 1 << finalize;
+
+    auto opts = mongocxx::options::find{};
+    opts.sort(order.view());
+    opts.projection(projection.view());
+    opts.limit(1);
+
+    for (const auto& doc : collection.find(filter.view(), opts))
+    {
+        return system_clock::time_point(milliseconds(doc["_id"].get_date().value.count()));
+    }
+
+    return timepoint_type();
+}
+
+// copies the days missing in the store from DB, the store is either
+// the tick_store or the tick_archive; a day is written once, so only the
+// complete days are copied: the days followed by a tick in DB
+template <typename Store>
+static bool fill_days(const Store& store, symbol sym, timepoint_type from, timepoint_type to)
+{
+    try
+    {
+        const auto complete_until = std::min<timepoint_type>(last_db_tick_time(sym), system_clock::now());
+
+        for (auto day = tick_store::day_start(from); day < to; day += hours(24))
+        {
+            if (day + hours(24) > complete_until)
+            {
+                logger::instance().info("Skipped the incomplete day " + store.get_path(sym, day));
+                break; // the following days are not complete either
+            }
+
+            if (!store.exists(sym, day))
+            {
+                db_tick_source source(sym, day, day + hours(24));
+
+                if (!store.write(sym, day, source))
+                {
+                    logger::instance().error("Failed to write " + store.get_path(sym, day));
+                    return false;
+                }
+            }
+        }
+
+        return true;
+    }
+    catch (const std::exception& x)
+    {
+        DEBUG_TRACE("fill_days(): %s", x.what());
+    }
+
+    return false;
+}
+
+bool fill_tick_store(const tick_store& store, symbol sym, timepoint_type from, timepoint_type to)
+{
+    return fill_days(store, sym, from, to);
+}
+
+bool fill_tick_archive(const tick_archive& archive, symbol sym, timepoint_type from, timepoint_type to)
+{
+    return fill_days(archive, sym, from, to);
+}
+
+} // namespace fx
@@ -0,0 +1,112 @@
+#pragma once
+#include <mutex>
+#include <atomic>
+#include <memory>
+#include <thread>
+#include <vector>
+#include <exception>
+#include <condition_variable>
+#include "types.h"
+#include "symbol.h"
+#include "mongodb.h"
+#include "spsc_ring.h"
+#include "tick_store.h"
+#include "tick_archive.h"
+#include "tick_source.h"
+
+namespace fx {
+
+// Reads the ticks of [from, to) time range from the '<symbol>_ticks' collection.
+// The cursor is drained and decoded by a separate thread into a bounded ring,
+// next() only takes the ticks which are ready.
+class db_tick_source : public tick_source
+{
+public:
+    db_tick_source(symbol sym, timepoint_type from, timepoint_type to, int batch_size = 0);
+    ~db_tick_source();
+
+    bool next(tick_data& tick) override
+    {
+        return ring_.try_pop(tick) || wait_next(tick);
+    }
+
+private:
+    bool wait_next(tick_data& tick);
+    void reader_func();
+
+private:
+    static const size_t ring_capacity = 16 * 1024;
+
+    const int digits_;
+    mongodb::client_type client_; // must outlive the cursor
+    std::unique_ptr<mongocxx::cursor> cursor_ptr_;
+    spsc_ring<tick_data> ring_;
+    std::atomic_bool shutdown_;
+    std::exception_ptr error_;
+    std::thread thread_;
+};
+
+// Splits [from, to) time range into chunks which are fetched and decoded at
+// the same time by several worker threads, each with its own pooled client.
+// The chunks are handed out in time order, so the ticks stay sorted.
+class chunked_db_tick_source : public tick_source
+{
+public:
+    chunked_db_tick_source(symbol sym, timepoint_type from, timepoint_type to,
+        size_t nthreads, std::chrono::hours chunk_size, int batch_size = 0);
+    ~chunked_db_tick_source();
+
+    bool next(tick_data& tick) override
+    {
+        while (index_ >= count_)
+        {
+            if (!next_chunk())
+            {
+                return false;
+            }
+        }
+
+        tick = (*ticks_)[index_++];
+        return true;
+    }
+
+private:
+    struct chunk
+    {
+        timepoint_type from;
+        timepoint_type to;
+        std::vector<tick_data> ticks;
+        bool ready;
+        bool failed;
+    };
+
+    bool next_chunk();
+    void worker_func();
+
+private:
+    const symbol symbol_;
+    const int batch_size_;
+    const size_t window_; // max number of chunks fetched ahead of the reader
+
+    std::vector<chunk> chunks_;
+    size_t fetch_index_; // next chunk to fetch
+    size_t read_index_;  // chunk being read
+
+    // the chunk being read, accessed by the reader thread only
+    const std::vector<tick_data>* ticks_;
+    size_t index_;
+    size_t count_;
+
+    std::atomic_bool shutdown_;
+    std::mutex lock_;
+    std::condition_variable ready_cond_;
+    std::condition_variable space_cond_;
+    std::vector<std::thread> workers_;
+};
+
+// copy the days of [from, to) time range missing in the store from DB;
+// the days which are not complete in DB yet are skipped
+bool fill_tick_store(const tick_store& store, symbol sym, timepoint_type from, timepoint_type to);
+bool fill_tick_archive(const tick_archive& archive, symbol sym, timepoint_type from, timepoint_type to);
+
+} // namespace fx
@@ -13,31 +13,31 @@ namespace fx {
 
 class dummy_order_callback : public order_callback
 {
-    void on_order_submitted(fx_engine& eng, order_cptr order_ptr) override
+    void on_order_submitted(fx_engine& eng, const order_snapshot& order) override
     {
-        DEBUG_TRACE("on_order_submitted(%lu)", order_ptr->get_id());
+        DEBUG_TRACE("on_order_submitted(%lu)", order.id);
     }
 
-    void on_order_opened(fx_engine& eng, order_cptr order_ptr) override
+    void on_order_opened(fx_engine& eng, const order_snapshot& order) override
     {
-        //DEBUG_TRACE("on_order_opened(%lu)", order_ptr->get_id());
+        //DEBUG_TRACE("on_order_opened(%lu)", order.id);
     }
 
-    void on_order_closed(fx_engine& eng, order_cptr order_ptr) override
+    void on_order_closed(fx_engine& eng, const order_snapshot& order) override
     {
-        //DEBUG_TRACE("on_order_closed(%lu). ", order_ptr->get_id());
-        //DEBUG_TRACE("on_order_closed(%s). ", time_to_string(order_ptr->get_open_tick().get_time()).c_str());
-        //eng.delete_order(order_ptr->get_id());
+        //DEBUG_TRACE("on_order_closed(%lu). ", order.id);
+        //DEBUG_TRACE("on_order_closed(%s). ", time_to_string(order.open_time).c_str());
+        //eng.delete_order(order.id);
     }
 
-    void on_order_modified(fx_engine& eng, order_cptr order_ptr) override
+    void on_order_modified(fx_engine& eng, const order_snapshot& order) override
     {
-        DEBUG_TRACE("on_order_modified(%lu)", order_ptr->get_id());
+        DEBUG_TRACE("on_order_modified(%lu)", order.id);
     }
 
-    void on_order_deleted(fx_engine& eng, order_cptr order_ptr) override
+    void on_order_deleted(fx_engine& eng, const order_snapshot& order) override
     {
-        DEBUG_TRACE("on_order_deleted(%lu)", order_ptr->get_id());
+        DEBUG_TRACE("on_order_deleted(%lu)", order.id);
     }
 };
 
@@ -1,9 +1,9 @@
 #pragma once
+#include <atomic>
 #include <thread>
-#include <vector>
 #include "event.h"
 #include "symbol.h"
-#include "mongodb.h"
+#include "tick_source.h"
 #include "data_feeder.h"
 
 namespace fx {
@@ -22,6 +22,12 @@ public:
         stop_event_.wait();
     }
 
+    // true if the replay was stopped by an error rather than by the end of data
+    bool has_failed() const
+    {
+        return failed_;
+    }
+
 private:
     void run();
 
@@ -33,11 +39,11 @@ private:
     const bool use_cache_;
 
     bool running_;
+    std::atomic_bool failed_;
     std::unique_ptr<std::thread> thread_ptr_;
-    std::unique_ptr<mongocxx::cursor> cursor_ptr_;
+    tick_source_ptr source_ptr_;
 
     mutable event stop_event_;
-    std::vector<tick_data> cache_;
 };
 
 typedef std::shared_ptr<dummy_feeder> dummy_feeder_ptr;
@@ -1,55 +1,445 @@
 #pragma once
-#include <queue>
 #include <mutex>
-#include <vector>
+#include <atomic>
+#include <memory>
 #include <thread>
+#include <chrono>
+#include <string>
 #include "event.h"
+#include "debug.h"
+#include "executor.h"
+#include "mpsc_ring.h"
+#include "thread_utils.h"
 
 namespace fx {
 
-struct base_event
+// where the events are executed
+enum class dispatch_mode
 {
-    virtual ~base_event() = default;
-    virtual void operator ()() = 0;
+    queued,         // on a consumer thread of the queue (live trading)
+    shared,         // on the shared executor, in order (many engines)
+    inline_dispatch // on the pushing thread, in push_event() (backtests)
 };
 
-typedef std::shared_ptr<base_event> base_event_ptr;
+// what a producer does when the queue is full
+enum class overflow_policy
+{
+    block,    // waits for the consumer
+    conflate, // a tick replaces the previous tick which has not fit, the other events wait
+    drop      // drops a tick and counts it, the other events wait
+};
+
+// "block" (default), "conflate" or "drop"
+inline overflow_policy overflow_policy_from_string(const std::string& s)
+{
+    if (s == "conflate")
+    {
+        return overflow_policy::conflate;
+    }
+
+    if (s == "drop")
+    {
+        return overflow_policy::drop;
+    }
+
+    return overflow_policy::block;
+}
+
+struct queue_stats
+{
+    uint64_t pushed;
+    uint64_t executed;
+    uint64_t dropped;
+    uint64_t conflated;
+    size_t size;
+    size_t high_water;     // the largest number of queued events
+    double avg_latency_us; // from push to execution
+    double max_latency_us;
+};
 
-class event_queue
+// Executes the events on a consumer thread. The events are kept inline in a
+// bounded lock-free ring, so pushing an event neither locks nor allocates;
+// the consumer is only woken up when it sleeps on an empty ring. What happens
+// when the ring is full is set by the overflow policy. The thread settings
+// name and pin the consumer thread and tell how it waits on an empty ring.
+// In the shared mode the queue is a strand of the executor instead: it is
+// scheduled when an event arrives and runs on one worker at a time.
+// An event type must provide 'bool is_conflatable() const'.
+template <typename Event>
+class event_queue : private executor_task
 {
 public:
-    explicit event_queue(size_t nthreads);
-    virtual ~event_queue();
+    // the ring is allocated up front, so the default is kept small enough
+    // for many engines on one host
+    static const size_t default_capacity = 4 * 1024;
+
+    event_queue(dispatch_mode mode, size_t capacity = default_capacity,
+        overflow_policy policy = overflow_policy::block,
+        const thread_settings& settings = thread_settings()) :
+        mode_(mode), policy_(policy), settings_(settings), shutdown_(false), sleeping_(false),
+        scheduled_(false), running_(0), executor_(nullptr), ring_(capacity),
+        has_pending_(false), pushed_(0), executed_(0), dropped_(0), conflated_(0),
+        high_water_(0), latency_sum_ns_(0), latency_max_ns_(0)
+    {
+        if (mode_ == dispatch_mode::queued)
+        {
+            thread_ptr_ = std::make_unique<std::thread>(&event_queue::thread_func, this);
+        }
+        else if (mode_ == dispatch_mode::shared)
+        {
+            executor_ = &executor::instance();
+        }
+    }
+
+    virtual ~event_queue()
+    {
+        stop();
+    }
+
+    // delete copy constructor and assign operator
+    event_queue(event_queue const&) = delete;
+    event_queue& operator=(event_queue const&) = delete;
+
+    bool push_event(Event&& e)
+    {
+        if (shutdown_.load(std::memory_order_relaxed))
+        {
+            return false;
+        }
+
+        if (mode_ == dispatch_mode::inline_dispatch)
+        {
+            pushed_.fetch_add(1, std::memory_order_relaxed);
+            execute(e);
+            executed_.fetch_add(1, std::memory_order_relaxed);
+            return true;
+        }
+
+        entry x;
+        x.event = std::move(e);
+        x.time_ns = now_ns();
+
+        // a conflated tick goes before any newer event
+        for (unsigned n = 0; has_pending_.load(std::memory_order_acquire) && !flush_pending(); n++)
+        {
+            if (x.event.is_conflatable())
+            {
+                return conflate(std::move(x));
+            }
 
-    bool push_event(base_event_ptr eptr);
+            if (shutdown_.load(std::memory_order_relaxed))
+            {
+                return false;
+            }
+
+            wake();
+            backoff(n);
+        }
+
+        for (unsigned n = 0; !ring_.try_push(std::move(x)); n++)
+        {
+            if (shutdown_.load(std::memory_order_relaxed))
+            {
+                return false;
+            }
+
+            // only the ticks may be lost, a missing bar or order event would
+            // corrupt the bars and the order state, so these wait for room
+            if ((policy_ == overflow_policy::drop) && x.event.is_conflatable())
+            {
+                dropped_.fetch_add(1, std::memory_order_relaxed);
+                return false;
+            }
+
+            if ((policy_ == overflow_policy::conflate) && x.event.is_conflatable())
+            {
+                return conflate(std::move(x));
+            }
+
+            wake();
+            backoff(n); // full, let the consumer catch up
+        }
+
+        pushed_.fetch_add(1, std::memory_order_relaxed);
+        update_high_water();
+        wake();
+        return true;
+    }
 
     size_t size() const
     {
-        std::lock_guard<std::mutex> lock(lock_);
-        return queue_.size();
+        return ring_.size();
     }
 
-private:
-    typedef std::shared_ptr<std::thread> thread_ptr;
+    queue_stats get_stats() const
+    {
+        queue_stats s;
+        s.pushed = pushed_.load(std::memory_order_relaxed);
+        s.executed = executed_.load(std::memory_order_relaxed);
+        s.dropped = dropped_.load(std::memory_order_relaxed);
+        s.conflated = conflated_.load(std::memory_order_relaxed);
+        s.size = size();
+        s.high_water = high_water_.load(std::memory_order_relaxed);
+        s.avg_latency_us = (s.executed > 0) ?
+            latency_sum_ns_.load(std::memory_order_relaxed) / 1000.0 / s.executed : 0.0;
+        s.max_latency_us = latency_max_ns_.load(std::memory_order_relaxed) / 1000.0;
+        return s;
+    }
 
-    struct thread_context
+protected:
+    virtual void execute(Event& e) = 0;
+
+    // stops the consumer thread or the strand, the queued events are dropped;
+    // must be called by the derived destructor
+    void stop()
     {
-        thread_ptr thread_ptr_;
-        bool terminated_;
-    };
+        shutdown_ = true;
 
-    typedef std::shared_ptr<thread_context> thread_context_ptr;
+        if (thread_ptr_)
+        {
+            signal_.signal();
+            thread_ptr_->join();
+            thread_ptr_.reset();
+        }
+
+        // a running or scheduled strand sees the shutdown and lets the queue go
+        while (scheduled_.load(std::memory_order_acquire) || (running_.load(std::memory_order_acquire) > 0))
+        {
+            std::this_thread::yield();
+        }
+    }
 
 private:
-    base_event_ptr pop_event();
-    void thread_func(thread_context_ptr tc_ptr);
+    struct entry
+    {
+        Event event;
+        int64_t time_ns; // when pushed
+    };
+
+    static int64_t now_ns()
+    {
+        return std::chrono::duration_cast<std::chrono::nanoseconds>(
+            std::chrono::steady_clock::now().time_since_epoch()).count();
+    }
+
+    // producer side, moves the conflated tick into the ring if there is room
+    bool flush_pending()
+    {
+        std::lock_guard<std::mutex> lock(pending_lock_);
+
+        if (has_pending_.load(std::memory_order_relaxed))
+        {
+            if (!ring_.try_push(std::move(pending_)))
+            {
+                return false;
+            }
+
+            has_pending_.store(false, std::memory_order_release);
+            pushed_.fetch_add(1, std::memory_order_relaxed);
+            wake();
+        }
+
+        return true;
+    }
+
+    bool conflate(entry&& x)
+    {
+        { // scope
+            std::lock_guard<std::mutex> lock(pending_lock_);
+
+            if (has_pending_.load(std::memory_order_relaxed))
+            {
+                conflated_.fetch_add(1, std::memory_order_relaxed); // the previous tick is lost
+            }
+
+            pending_ = std::move(x);
+            has_pending_.store(true, std::memory_order_release);
+        }
+
+        wake();
+        return true;
+    }
+
+    // consumer side, takes the conflated tick when the ring is empty; a slot
+    // which is reserved but not written yet counts, it holds an older event
+    bool take_pending(entry& x)
+    {
+        if (!has_pending_.load(std::memory_order_acquire))
+        {
+            return false;
+        }
+
+        std::lock_guard<std::mutex> lock(pending_lock_);
+
+        if (!has_pending_.load(std::memory_order_relaxed) || !ring_.empty())
+        {
+            return false;
+        }
+
+        x = std::move(pending_);
+        has_pending_.store(false, std::memory_order_release);
+        pushed_.fetch_add(1, std::memory_order_relaxed);
+        return true;
+    }
+
+    void update_high_water()
+    {
+        const size_t n = ring_.size();
+        size_t hw = high_water_.load(std::memory_order_relaxed);
+
+        while ((n > hw) && !high_water_.compare_exchange_weak(hw, n, std::memory_order_relaxed))
+        {
+        }
+    }
+
+    void run(entry& x)
+    {
+        execute(x.event);
+
+        // the consumer is the only writer of these counters
+        const int64_t latency = now_ns() - x.time_ns;
+        executed_.store(executed_.load(std::memory_order_relaxed) + 1, std::memory_order_relaxed);
+        latency_sum_ns_.store(latency_sum_ns_.load(std::memory_order_relaxed) + latency, std::memory_order_relaxed);
+
+        if (latency > latency_max_ns_.load(std::memory_order_relaxed))
+        {
+            latency_max_ns_.store(latency, std::memory_order_relaxed);
+        }
+    }
+
+    void wake()
+    {
+        // pairs with the fence in thread_func() and run_batch(): either the
+        // consumer sees the new event or the producer sees the consumer idle
+        std::atomic_thread_fence(std::memory_order_seq_cst);
+
+        if (executor_)
+        {
+            if (!scheduled_.load(std::memory_order_relaxed) && !scheduled_.exchange(true))
+            {
+                executor_->schedule(this);
+            }
+        }
+        else if (sleeping_.load(std::memory_order_relaxed))
+        {
+            signal_.signal();
+        }
+    }
+
+    static void backoff(unsigned n)
+    {
+        if (n < 64)
+        {
+            // spin
+        }
+        else if (n < 128)
+        {
+            std::this_thread::yield();
+        }
+        else
+        {
+            std::this_thread::sleep_for(std::chrono::microseconds(100));
+        }
+    }
+
+    // the strand, on an executor worker
+    bool run_batch() override
+    {
+        const size_t batch_size = 64; // then the other strands get a turn
+        running_.fetch_add(1);
+        entry x;
+
+        for (size_t n = 0; (n < batch_size) && !shutdown_.load(std::memory_order_relaxed) &&
+            (ring_.try_pop(x) || take_pending(x)); ++n)
+        {
+            run(x);
+        }
+
+        scheduled_.store(false);
+        std::atomic_thread_fence(std::memory_order_seq_cst);
+
+        const bool more = !shutdown_.load(std::memory_order_relaxed) &&
+            (!ring_.empty() || has_pending_.load(std::memory_order_relaxed)) && !scheduled_.exchange(true);
+
+        // the next batch may already run on another worker, and the queue
+        // may be gone after this
+        running_.fetch_sub(1, std::memory_order_release);
+        return more;
+    }
+
+    void abandon() override
+    {
+        scheduled_.store(false, std::memory_order_release);
+    }
+
+    void thread_func()
+    {
+        using namespace std::chrono_literals;
+        const unsigned spin_count = 16 * 1024;
+        unsigned idle = 0;
+        entry x;
+
+        apply_thread_settings(settings_);
+
+        while (!shutdown_)
+        {
+            if (ring_.try_pop(x) || take_pending(x))
+            {
+                idle = 0;
+                run(x);
+                continue;
+            }
+
+            if ((settings_.wait == wait_strategy::busy_poll) ||
+                ((settings_.wait == wait_strategy::spin_park) && (++idle < spin_count)))
+            {
+                cpu_relax();
+                continue;
+            }
+
+            idle = 0;
+
+            sleeping_.store(true, std::memory_order_relaxed);
+            std::atomic_thread_fence(std::memory_order_seq_cst);
+
+            if (!ring_.try_pop(x) && !take_pending(x))
+            {
+                signal_.wait(100ms);
+                sleeping_.store(false, std::memory_order_relaxed);
+                continue;
+            }
+
+            sleeping_.store(false, std::memory_order_relaxed);
+            run(x);
+        }
+    }
 
 private:
-    bool shutdown_;
-    mutable std::mutex lock_;
-    mutable event signal_;
-    std::queue<base_event_ptr> queue_;
-    std::vector<thread_context_ptr> threads_;
+    const dispatch_mode mode_;
+    const overflow_policy policy_;
+    const thread_settings settings_;
+    std::atomic_bool shutdown_;
+    std::atomic_bool sleeping_;
+    std::atomic_bool scheduled_; // the strand is queued or running on the executor
+    std::atomic<int> running_;   // the workers inside run_batch()
+    executor* executor_;
+    event signal_;
+    mpsc_ring<entry> ring_;
+    std::unique_ptr<std::thread> thread_ptr_;
+
+    // the conflated tick which has not fit into the ring
+    std::mutex pending_lock_;
+    std::atomic_bool has_pending_;
+    entry pending_;
+
+    // metrics
+    std::atomic<uint64_t> pushed_;
+    std::atomic<uint64_t> executed_;
+    std::atomic<uint64_t> dropped_;
+    std::atomic<uint64_t> conflated_;
+    std::atomic<size_t> high_water_;
+    std::atomic<int64_t> latency_sum_ns_;
+    std::atomic<int64_t> latency_max_ns_;
 };
 
 } // namespace fx
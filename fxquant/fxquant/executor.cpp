@@ -0,0 +1,170 @@
+#include <cstdint>
+#include <algorithm>
+#include "debug.h"
+#include "config.h"
+#include "executor.h"
+
+using namespace std::chrono;
+
+namespace {
+
+// the index of the worker running on this thread, if any
+thread_local size_t current_worker = SIZE_MAX;
+
+size_t worker_count()
+{
+    const int n = fx::config::instance().read_int("executor", "workers", 0);
+
+    if (n > 0)
+    {
+        return static_cast<size_t>(n);
+    }
+
+    return std::max<size_t>(std::thread::hardware_concurrency(), 1);
+}
+}
+
+namespace fx {
+
+executor::executor() :
+    settings_(get_thread_settings("executor")),
+    next_worker_(0), pending_(0), idle_(0), shutdown_(false)
+{
+    const size_t n = worker_count();
+
+    for (size_t i = 0; i < n; ++i)
+    {
+        workers_.push_back(std::make_unique<worker>());
+    }
+
+    for (size_t i = 0; i < n; ++i)
+    {
+        threads_.emplace_back(&executor::worker_func, this, i);
+    }
+}
+
+executor::~executor()
+{
+    { // scope
+        std::lock_guard<std::mutex> lock(idle_lock_);
+        shutdown_ = true;
+        idle_cond_.notify_all();
+    }
+
+    for (auto& t : threads_)
+    {
+        t.join();
+    }
+
+    // the tasks still queued are released, so their owners can stop
+    for (auto& w : workers_)
+    {
+        for (auto task : w->tasks)
+        {
+            task->abandon();
+        }
+
+        w->tasks.clear();
+    }
+
+    DEBUG_TRACE("~executor()");
+}
+
+void executor::schedule(executor_task* task)
+{
+    DEBUG_REQUIRE(task);
+
+    if (shutdown_.load(std::memory_order_relaxed))
+    {
+        task->abandon();
+        return;
+    }
+
+    const size_t index = (current_worker != SIZE_MAX) ? current_worker :
+        (next_worker_.fetch_add(1, std::memory_order_relaxed) % workers_.size());
+
+    push(index, task);
+}
+
+void executor::push(size_t index, executor_task* task)
+{
+    { // scope
+        std::lock_guard<std::mutex> lock(workers_[index]->lock);
+        workers_[index]->tasks.push_back(task);
+    }
+
+    // pairs with the check in worker_func(): either a parking worker
+    // sees the task or the task is seen with the worker idle
+    pending_.fetch_add(1);
+
+    if (idle_.load() > 0)
+    {
+        std::lock_guard<std::mutex> lock(idle_lock_);
+        idle_cond_.notify_one();
+    }
+}
+
+bool executor::pop(size_t index, executor_task*& task)
+{
+    const size_t n = workers_.size();
+
+    // the own tasks first, then the tasks of the others; the oldest task
+    // of a queue goes first either way, so no strand waits behind newer ones
+    for (size_t i = 0; i < n; ++i)
+    {
+        worker& w = *workers_[(index + i) % n];
+        std::lock_guard<std::mutex> lock(w.lock);
+
+        if (!w.tasks.empty())
+        {
+            task = w.tasks.front();
+            w.tasks.pop_front();
+            pending_.fetch_sub(1);
+            return true;
+        }
+    }
+
+    return false;
+}
+
+void executor::worker_func(size_t index)
+{
+    const unsigned spin_count = 16 * 1024;
+    unsigned idle = 0;
+
+    // the workers are pinned to consecutive cores, wrapped around the cores
+    apply_thread_settings(get_thread_settings("executor", index));
+    current_worker = index;
+
+    while (!shutdown_)
+    {
+        executor_task* task = nullptr;
+
+        if (pop(index, task))
+        {
+            idle = 0;
+
+            if (task->run_batch())
+            {
+                push(index, task); // more work, after the other ready tasks
+            }
+
+            continue;
+        }
+
+        if ((settings_.wait == wait_strategy::busy_poll) ||
+            ((settings_.wait == wait_strategy::spin_park) && (++idle < spin_count)))
+        {
+            cpu_relax();
+            continue;
+        }
+
+        idle = 0;
+        std::unique_lock<std::mutex> lock(idle_lock_);
+        idle_.fetch_add(1);
+        idle_cond_.wait_for(lock, 100ms, [this]() { return shutdown_ || (pending_.load() > 0); });
+        idle_.fetch_sub(1);
+    }
+}
+
+} // namespace fx
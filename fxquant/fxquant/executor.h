@@ -0,0 +1,79 @@
+#pragma once
+#include <mutex>
+#include <deque>
+#include <atomic>
+#include <memory>
+#include <thread>
+#include <vector>
+#include <condition_variable>
+#include "thread_utils.h"
+
+namespace fx {
+
+// a unit of serial work run by the executor, e.g. the events of one queue;
+// the executor never runs the same task on two workers at once
+class executor_task
+{
+public:
+    virtual ~executor_task() = default;
+
+    // runs a batch of the work, returns true if the task must be scheduled again
+    virtual bool run_batch() = 0;
+
+    // called instead of run_batch() once the executor has stopped
+    virtual void abandon() = 0;
+};
+
+// A fixed number of worker threads shared by all the engines. Every worker
+// has its own deque of ready tasks; a task scheduled by a worker stays on
+// that worker, the other ones are spread over the workers, and an idle worker
+// steals from the others before it parks.
+class executor // singleton
+{
+public:
+    static executor& instance()
+    {
+        static executor executor_instance;
+        return executor_instance;
+    }
+
+    // delete copy and move constructors and assign operators
+    executor(executor const&) = delete;
+    executor(executor&&) = delete;
+    executor& operator=(executor const&) = delete;
+    executor& operator=(executor &&) = delete;
+
+    void schedule(executor_task* task);
+
+    size_t get_worker_count() const
+    {
+        return workers_.size();
+    }
+
+private:
+    executor();
+    ~executor();
+
+    struct worker
+    {
+        std::mutex lock;
+        std::deque<executor_task*> tasks;
+    };
+
+    void push(size_t index, executor_task* task);
+    bool pop(size_t index, executor_task*& task);
+    void worker_func(size_t index);
+
+private:
+    const thread_settings settings_;
+    std::vector<std::unique_ptr<worker>> workers_;
+    std::vector<std::thread> threads_;
+    std::atomic<size_t> next_worker_;
+    std::atomic<size_t> pending_;
+    std::atomic<size_t> idle_;
+    std::atomic_bool shutdown_;
+    std::mutex idle_lock_;
+    std::condition_variable idle_cond_;
+};
+
+} // namespace fx
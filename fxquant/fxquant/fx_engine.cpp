@@ -1,18 +1,76 @@
 #include "debug.h"
+#include "config.h"
+#include "logger.h"
 #include "strategy.h"
 #include "fx_engine.h"
 #include "gui_server.h"
+#include "thread_utils.h"
+#include <atomic>
 #include <chrono>
+#include <vector>
+#include <sstream>
+#include <algorithm>
 
 namespace fx {
 
+namespace {
+
+size_t next_engine_index()
+{
+    static std::atomic<size_t> count(0);
+    return count++;
+}
+
+size_t data_queue_capacity()
+{
+    const int n = config::instance().read_int("engine", "queue_capacity",
+        static_cast<int>(data_event_queue::default_capacity));
+    return (n > 0) ? static_cast<size_t>(n) : 1;
+}
+
+size_t order_queue_capacity()
+{
+    const int n = config::instance().read_int("engine", "order_queue_capacity",
+        static_cast<int>(order_event_queue::default_order_capacity));
+    return (n > 0) ? static_cast<size_t>(n) : 1;
+}
+
+size_t order_inbox_capacity()
+{
+    const int n = config::instance().read_int("engine", "order_inbox_capacity", 4096);
+    return (n > 0) ? static_cast<size_t>(n) : 1;
+}
+
+overflow_policy data_queue_policy()
+{
+    return overflow_policy_from_string(config::instance().read_string("engine", "overflow", "block"));
+}
+
+std::string stats_to_string(const queue_stats& s)
+{
+    std::ostringstream oss;
+    oss << "pushed=" << s.pushed << " executed=" << s.executed
+        << " dropped=" << s.dropped << " conflated=" << s.conflated
+        << " size=" << s.size << " high_water=" << s.high_water
+        << " latency avg=" << s.avg_latency_us << "us max=" << s.max_latency_us << "us";
+    return oss.str();
+}
+}
+
 fx_engine::fx_engine(data_feeder_ptr feeder_ptr, strategy_ptr sptr,
-    data_callback_ptr dcb_ptr, order_callback_ptr ocb_ptr) :
-    feeder_ptr_(feeder_ptr), strategy_ptr_(sptr), last_order_id_(0),
-    feeder_callback_ptr_(std::make_shared<feeder_callback>(*this)),
-    data_events_(std::make_shared<data_event_callback>(*this, dcb_ptr)),
-    order_events_(*this, ocb_ptr)
+    data_callback_ptr dcb_ptr, order_callback_ptr ocb_ptr, dispatch_mode mode) :
+    feeder_ptr_(feeder_ptr), strategy_ptr_(sptr), mode_(mode), index_(next_engine_index()),
+    last_order_id_(0),
+    new_orders_(order_inbox_capacity()),
+    data_callback_ptr_(std::make_shared<data_event_callback>(*this, dcb_ptr)),
+    data_events_(data_callback_ptr_, mode, data_queue_capacity(), data_queue_policy(),
+        get_thread_settings("data_queue", index_)),
+    order_events_(*this, ocb_ptr, mode, order_queue_capacity(), get_thread_settings("order_queue", index_))
 {
+    // the inline mode lets the feeder call the engine directly, without the queue
+    feeder_callback_ptr_ = (mode_ == dispatch_mode::inline_dispatch) ?
+        data_callback_ptr_ : std::make_shared<feeder_callback>(*this);
+
     DEBUG_REQUIRE(feeder_ptr_);
     DEBUG_REQUIRE(feeder_callback_ptr_);
     DEBUG_REQUIRE(strategy_ptr_);
@@ -35,10 +93,13 @@ bool fx_engine::submit_order(order_cptr optr, order_id_type& id)
         //clone_ptr->set_id(++last_order_id_); // and assign an id to it
         id = clone_ptr->get_id(); // return id to the calling code
 
-        // add order to the list of pending orders
-        std::lock_guard<std::mutex> lock(lock_);
-        new_orders_.push_back(clone_ptr);
-        return true;
+        // pass the order to the engine thread
+        if (new_orders_.try_push(std::move(clone_ptr)))
+        {
+            return true;
+        }
+
+        DEBUG_TRACE("submit_order(): the order inbox is full, order %lu rejected", id);
     }
 
     return false;
@@ -46,86 +107,226 @@ bool fx_engine::submit_order(order_cptr optr, order_id_type& id)
 
 bool fx_engine::modify_order(order_id_type id, order_cptr optr)
 {
-    //// auto p = closed_orders_.find(id);
-    //auto it = std::find_if(closed_orders_.begin(), closed_orders_.end(),
-    //    [id](order_ptr optr) { return optr->get_id() == id; });
-
-    //if (it != closed_orders_.end())
-    //{
-    //    auto p = *it;
-
-    //    if (p && !p->is_closed())
-    //    {
-    //        if (optr->get_stop_loss() != p->get_stop_loss())
-    //        {
-    //            p->set_stop_loss(optr->get_stop_loss());
-    //        }
-
-    //        if (optr->get_take_profit() != p->get_take_profit())
-    //        {
-    //            p->set_take_profit(optr->get_take_profit());
-    //        }
-
-    //        if (optr->get_comment() != p->get_comment())
-    //        {
-    //            p->set_comment(optr->get_comment());
-    //        }
-
-    //        order_events_.push_order_modified_event(p);
-    //        return true;
-    //    }
-    //}
-
-    return false; // order not found
+    auto p = orders_.find(id);
+
+    if (!optr || !p || p->is_closed())
+    {
+        return false; // order not found
+    }
+
+    // try the new levels on a copy, so an invalid level changes nothing
+    auto trial = p->clone();
+
+    if ((optr->has_stop_loss() && !trial->set_stop_loss(optr->get_stop_loss())) ||
+        (optr->has_take_profit() && !trial->set_take_profit(optr->get_take_profit())))
+    {
+        return false; // invalid level
+    }
+
+    const bool levels_changed =
+        (optr->get_stop_loss_value() != p->get_stop_loss_value()) ||
+        (optr->get_take_profit_value() != p->get_take_profit_value());
+
+    if (levels_changed)
+    {
+        if (optr->has_stop_loss())
+        {
+            p->set_stop_loss(optr->get_stop_loss());
+        }
+        else
+        {
+            p->reset_stop_loss();
+        }
+
+        if (optr->has_take_profit())
+        {
+            p->set_take_profit(optr->get_take_profit());
+        }
+        else
+        {
+            p->reset_take_profit();
+        }
+
+        if (p->is_opened())
+        {
+            close_triggers_.watch(p); // the old levels become stale
+        }
+    }
+
+    if (optr->get_comment() != p->get_comment())
+    {
+        p->set_comment(optr->get_comment());
+    }
+
+    order_events_.push_order_modified_event(p);
+    return true;
 }
 
 bool fx_engine::delete_order(order_id_type id)
 {
-    //// try to delete the closed order
-    //order_ptr optr = nullptr;
-
-    //auto it = std::find_if(closed_orders_.begin(), closed_orders_.end(),
-    //    [&id](order_ptr optr) { return optr->get_id() == id; });    
-
-    //if (it != closed_orders_.end()) // closed order not found
-    //{
-    //    optr = *it;
-    //    closed_orders_.erase(it);
-    //}
-    //else
-    //{
-    //    // try to delete the pending order
-    //    auto it = std::find_if(pending_orders_.begin(), pending_orders_.end(),
-    //        [&id](order_ptr optr) { return optr->get_id() == id; });
-
-    //    if (it != pending_orders_.end())
-    //    {
-    //        optr = *it;
-    //        pending_orders_.erase(it);
-    //    }
-    //}
-
-    //if (optr)
-    //{
-    //    // order deleted - inform the engine about this
-    //    order_events_.push_order_deleted_event(optr);
-    //    return true;
-    //}
-
-    return false; // order not found
+    auto optr = orders_.find(id);
+
+    if (!optr)
+    {
+        return false; // order not found
+    }
+
+    if (optr->is_closed())
+    {
+        auto e = orders_.find_entry(optr);
+
+        if (e && (e->where == order_index::place::closed))
+        {
+            closed_orders_.erase(e->pos);
+            e->where = order_index::place::none;
+        }
+    }
+    else if (optr->is_opened() || !pending_orders_.remove(optr))
+    {
+        return false; // an opened order must be closed first
+    }
+
+    orders_.erase(id);
+
+    // order deleted - inform the engine about this
+    order_events_.push_order_deleted_event(optr);
+    return true;
 }
 
 void fx_engine::add_new_orders()
 {
-    std::lock_guard<std::mutex> lock(lock_);
+    // at most one inbox of orders per tick, so the producers cannot hold
+    // the engine thread here
+    order_ptr optr;
 
-    for (auto optr : new_orders_)
+    for (size_t n = new_orders_.capacity(); (n > 0) && new_orders_.try_pop(optr); --n)
     {
-        pending_orders_.push_back(optr);
+        if (!orders_.insert(optr))
+        {
+            DEBUG_TRACE("add_new_orders(): duplicate order id %lu", optr->get_id());
+        }
+
+        pending_orders_.add(optr);
         order_events_.push_order_submitted_event(optr);
     }
 }
 
+void fx_engine::open_pending_orders(const tick_data& tick)
+{
+    if (pending_orders_.empty())
+    {
+        return;
+    }
+
+    order_list triggered;
+    pending_orders_.take_triggered(tick, triggered);
+
+    for (auto optr : triggered)
+    {
+        if (optr->open(tick)) // open the order
+        {
+            // move order to the list of opened orders
+            add_opened_order(optr);
+
+            // inform the engine that the order was opened
+            order_events_.push_order_opened_event(optr);
+        }
+    }
+}
+
+void fx_engine::add_opened_order(order_ptr optr)
+{
+    orders_.insert(optr); // the orders opened by a strategy are new to the engine
+    opened_orders_.push_back(optr);
+
+    if (auto e = orders_.find_entry(optr))
+    {
+        e->where = order_index::place::opened;
+        e->pos = std::prev(opened_orders_.end());
+    }
+
+    close_triggers_.watch(optr);
+}
+
+void fx_engine::add_closed_order(order_ptr optr)
+{
+    closed_orders_.push_back(optr);
+
+    if (auto e = orders_.find_entry(optr))
+    {
+        e->where = order_index::place::closed;
+        e->pos = std::prev(closed_orders_.end());
+    }
+}
+
+bool fx_engine::remove_opened_order(const order_ptr& optr)
+{
+    auto e = orders_.find_entry(optr);
+
+    if (!e || (e->where != order_index::place::opened))
+    {
+        return false;
+    }
+
+    opened_orders_.erase(e->pos);
+    e->where = order_index::place::none;
+    return true;
+}
+
+bool fx_engine::close_opened_order(const tick_data& tick, const order_ptr& optr)
+{
+    auto e = orders_.find_entry(optr);
+
+    if (!e || (e->where != order_index::place::opened) || !optr->close(tick))
+    {
+        return false;
+    }
+
+    // move order to the list of closed orders
+    opened_orders_.erase(e->pos);
+    add_closed_order(optr);
+
+    // inform the engine that the order was closed
+    order_events_.push_order_closed_event(optr);
+    return true;
+}
+
+void fx_engine::close_opened_orders(const tick_data& tick)
+{
+    for (auto optr : opened_orders_)
+    {
+        if (auto e = orders_.find_entry(optr))
+        {
+            e->where = order_index::place::none;
+        }
+
+        if (optr->close(tick))
+        {
+            add_closed_order(optr);
+            order_events_.push_order_closed_event(optr);
+        }
+    }
+
+    opened_orders_.clear();
+}
+
+void fx_engine::take_closing_orders(const tick_data& tick, order_list& closing)
+{
+    order_list triggered;
+    close_triggers_.take_triggered(tick, triggered);
+
+    // O(1) per closing order, the other opened orders are not touched
+    for (const auto& optr : triggered)
+    {
+        if (!remove_opened_order(optr))
+        {
+            opened_orders_.remove(optr); // not indexed, e.g. a duplicate id
+        }
+    }
+
+    closing.splice(closing.end(), triggered);
+}
+
 // fx_engine::data_event_callback
 
 fx_engine::data_event_callback::data_event_callback(fx_engine& e, data_callback_ptr cb_ptr) :
@@ -137,6 +338,7 @@ void fx_engine::data_event_callback::on_tick(const tick_data& tick)
 {
     engine_.latest_tick_ = tick;
     engine_.add_new_orders();
+    engine_.open_pending_orders(tick);
 
     engine_.info_data_.reset();
 
@@ -159,8 +361,6 @@ void fx_engine::data_event_callback::on_tick(const tick_data& tick)
 
 void fx_engine::data_event_callback::on_bar(timeframe_type tf, const bar_data& bar)
 {
-    ALWAYS_TRACE("data_events_.size()=%lu", engine_.data_events_.size());
-
     // save this bar
     engine_.bars_.put_bar(tf, bar);
 
@@ -175,6 +375,38 @@ void fx_engine::data_event_callback::on_bar(timeframe_type tf, const bar_data& b
     }
 }
 
+void fx_engine::data_event_callback::on_history(timeframe_type tf, const bar_array_type& bars)
+{
+    if (bars.empty())
+    {
+        return;
+    }
+
+    // save the bars at once
+    engine_.bars_.put_bars(tf, bars.data(), bars.size());
+
+    // the strategies keep the state of the latest bar only,
+    // so the last bar is enough to bring them up to date
+    engine_.strategy_ptr_->on_bar(tf, bars.back());
+
+    for (const auto& bar : bars)
+    {
+        gui_server::instance().on_bar(engine_.get_symbol(), tf, bar);
+    }
+
+    if (cb_ptr_)
+    {
+        // call the external callback function
+        cb_ptr_->on_history(tf, bars);
+    }
+}
+
+void fx_engine::log_queue_stats() const
+{
+    logger::instance().info("Data queue: " + stats_to_string(get_data_queue_stats()));
+    logger::instance().info("Order queue: " + stats_to_string(get_order_queue_stats()));
+}
+
 void fx_engine::calc_open_trades_stats()
 {
     auto& stats = strategy_ptr_->stats_;
@@ -3,6 +3,7 @@
 #include <vector>
 #include <memory>
 #include "bar_data.h"
+#include "mpsc_ring.h"
 #include "info_data.h"
 #include "tick_data.h"
 #include "data_feeder.h"
@@ -11,6 +12,9 @@
 #include "order_callback.h"
 #include "data_event_queue.h"
 #include "order_event_queue.h"
+#include "order_index.h"
+#include "pending_order_book.h"
+#include "close_trigger_index.h"
 
 namespace fx {
 
@@ -20,25 +24,35 @@ typedef std::shared_ptr<strategy> strategy_ptr;
 class fx_engine
 {
 public:
-    typedef std::list<order_ptr> order_list;
+    typedef order_index::order_list order_list;
 
     fx_engine(
         data_feeder_ptr df_ptr,
         strategy_ptr sptr,
         data_callback_ptr dcb_ptr = nullptr,
-        order_callback_ptr ocb_ptr = nullptr);
+        order_callback_ptr ocb_ptr = nullptr,
+        dispatch_mode mode = dispatch_mode::queued);
 
     ~fx_engine();
 
-    // submit a new order
+    // submit a new order from any thread, without blocking; the engine takes
+    // it at the next tick. false if the order inbox is full
     bool submit_order(order_cptr optr, order_id_type& id);
 
-    // modify the existing order
+    // modify the stop loss, the take profit and the comment of a pending or
+    // opened order; called on the engine thread, i.e. by the strategy. The
+    // orders submitted since the last tick are not known to the engine yet
     bool modify_order(order_id_type id, order_cptr optr);
 
-    // delete a closed or pending order
+    // delete a closed or pending order; called on the engine thread
     bool delete_order(order_id_type id);
 
+    // the order with the id, nullptr if the engine has no such order
+    order_ptr find_order(order_id_type id) const
+    {
+        return orders_.find(id);
+    }
+
     const bar_collector& get_bar_collector() const
     {
         return bars_;
@@ -59,6 +73,23 @@ public:
         return feeder_ptr_->get_symbol();
     }
 
+    dispatch_mode get_dispatch_mode() const
+    {
+        return mode_;
+    }
+
+    queue_stats get_data_queue_stats() const
+    {
+        return data_events_.get_stats();
+    }
+
+    queue_stats get_order_queue_stats() const
+    {
+        return order_events_.get_stats();
+    }
+
+    void log_queue_stats() const;
+
     double get_point() const
     {
         return symbol_pip(get_symbol());
@@ -84,6 +115,7 @@ private:
     private:
         void on_tick(const tick_data& tick) override;
         void on_bar(timeframe_type tf, const bar_data& bar) override;
+        void on_history(timeframe_type tf, const bar_array_type& bars) override;
 
     private:
         fx_engine& engine_;
@@ -106,34 +138,65 @@ private:
             engine_.data_events_.push_bar_event(time_frame, bar);
         }
 
+        void on_history(timeframe_type time_frame, const bar_array_type& bars) override
+        {
+            engine_.data_events_.push_history_event(time_frame, bars);
+        }
+
     private:
         fx_engine& engine_;
     };
 
     void add_new_orders();
 
+    // opens the pending orders triggered by the tick
+    void open_pending_orders(const tick_data& tick);
+
+    // adds an order to the opened orders and watches its stop loss and take profit
+    void add_opened_order(order_ptr optr);
+
+    // adds a closed order to the closed orders
+    void add_closed_order(order_ptr optr);
+
+    // removes an order from the opened orders in O(1), false if it is not there
+    bool remove_opened_order(const order_ptr& optr);
+
+    // closes an opened order and moves it to the closed orders in O(1)
+    bool close_opened_order(const tick_data& tick, const order_ptr& optr);
+
+    // closes all opened orders, the ones which fail to close are dropped
+    void close_opened_orders(const tick_data& tick);
+
+    // takes the opened orders whose stop loss or take profit is hit by the tick
+    // out of the opened orders
+    void take_closing_orders(const tick_data& tick, order_list& closing);
+
 private:
     const data_feeder_ptr feeder_ptr_;
     const strategy_ptr strategy_ptr_;
+    const dispatch_mode mode_;
+    const size_t index_; // the number of the engine, offsets the cores of its threads
 
     order_id_type last_order_id_;
     data_callback_ptr feeder_callback_ptr_;
 
     // queues of orders
-    order_list new_orders_;
-    order_list pending_orders_;
+    mpsc_ring<order_ptr> new_orders_; // the submitted orders, drained at each tick
+    pending_order_book pending_orders_;
     order_list opened_orders_;
     order_list closed_orders_;
+    close_trigger_index close_triggers_; // the levels of opened_orders_
+    order_index orders_; // the pending, opened and closed orders by id
 
     bar_collector bars_; // NOTE: bars_ must be declared *before* data_events_!
     tick_data latest_tick_;
 
+    data_callback_ptr data_callback_ptr_; // handles the data events
+
     data_event_queue data_events_;
     order_event_queue order_events_;
 
     info_data info_data_;
-
-    mutable std::mutex lock_;
 };
 
 typedef std::shared_ptr<fx_engine> engine_ptr;
@@ -3,6 +3,7 @@
 #include "logger.h"
 #include "message.h"
 #include "gui_context.h"
+#include "thread_utils.h"
 #include "engine_registry.h"
 
 namespace {
@@ -28,6 +29,16 @@ bool ticks_equal(const fx::tick_data& a, const fx::tick_data& b)
 
     return true;
 }
+
+// the layout of a bar in a bar array message
+struct wire_bar
+{
+    double o;
+    double h;
+    double l;
+    double c;
+    time_t t;
+};
 }
 
 namespace fx {
@@ -223,24 +234,24 @@ bool gui_context::add_tick(symbol sym, const tick_data& tick)
     return added;
 }
 
-bool gui_context::add_order(order_cptr optr, order_action action)
+bool gui_context::add_order(const order_snapshot& order, order_action action)
 {
     bool added = false;
 
     std::lock_guard<std::mutex> lock(data_lock_);
-    auto i1 = state_map_.find(optr->get_symbol());
+    auto i1 = state_map_.find(order.sym);
 
     if (i1 != state_map_.end())
     {
         auto& v = i1->second.orders_;
-        v.push_back({ optr, action });
+        v.push_back({ order, action });
         added = true;
     }
     else // add new symbol
     {
         state new_state;
-        new_state.orders_ = {{ optr, action }};
-        state_map_.insert({ optr->get_symbol(), new_state });
+        new_state.orders_ = {{ order, action }};
+        state_map_.insert({ order.sym, new_state });
         added = true;
     }
 
@@ -399,13 +410,21 @@ bool gui_context::send_bars()
                 }
 
                 size_t n = bars_left >= 10 ? 10 : bars_left;
-                const auto* p = &bars_to_send[0] + bars_sent;
+
+                // the GUI reads the prices as doubles
+                wire_bar wire[10];
+
+                for (size_t i = 0; i < n; ++i)
+                {
+                    const bar_data& bar = bars_to_send[bars_sent + i];
+                    wire[i] = { bar.o, bar.h, bar.l, bar.c, bar.t };
+                }
 
                 size_t bytes = 0;
-                socket::error_code err = sock_ptr_->write(p, n * sizeof(bar_data), bytes, 8s);
+                socket::error_code err = sock_ptr_->write(wire, n * sizeof(wire_bar), bytes, 8s);
 
                 if ((err != socket::error_code::success) ||
-                    (bytes != n * sizeof(bar_data)))
+                    (bytes != n * sizeof(wire_bar)))
                 {
                     break; // network error
                 }
@@ -436,7 +455,7 @@ bool gui_context::send_bars()
 
 bool gui_context::send_orders()
 {
-    std::vector<std::pair<order_cptr, order_action>> orders_to_send;
+    std::vector<std::pair<order_snapshot, order_action>> orders_to_send;
 
     if (true) // scope
     {
@@ -461,7 +480,7 @@ bool gui_context::send_orders()
 
     for (auto& o : orders_to_send)
     {
-        auto xml = o.first->to_xml_message(o.second);
+        auto xml = o.first.to_xml_message(o.second);
         //DEBUG_TRACE("%s", xml.c_str());
 
         if (!send_message(xml))
@@ -525,6 +544,8 @@ bool gui_context::send_status(status e)
 
 void gui_context::send_thread_func()
 {
+    apply_thread_settings(get_thread_settings("gui_send"));
+
     std::vector<engine_ptr> v;
     engine_registry::instance().get_engines(v);
 
@@ -567,6 +588,8 @@ void gui_context::send_thread_func()
 
 void gui_context::recv_thread_func()
 {
+    apply_thread_settings(get_thread_settings("gui_recv"));
+
     while (!canceled_ && !aborted_)
     {
         if (sock_ptr_->wait_for_readable(100ms) != socket::error_code::success)
@@ -30,7 +30,7 @@ public:
     bool add_bar(symbol sym, timeframe_type tf, const bar_data& bar);
     bool add_bars(symbol sym, timeframe_type tf, const std::vector<bar_data>& bars);
     bool add_tick(symbol sym, const tick_data& tick);
-    bool add_order(order_cptr optr, order_action action);
+    bool add_order(const order_snapshot& order, order_action action);
     bool add_orders(symbol sym);
     bool add_info(symbol sym, const std::string& info_xml);
 
@@ -61,7 +61,7 @@ private:
     {
         std::map<timeframe_type, std::vector<bar_data>> bars_;
         std::vector<tick_data> ticks_;
-        std::vector<std::pair<order_cptr, order_action>> orders_;
+        std::vector<std::pair<order_snapshot, order_action>> orders_;
         std::string info_;
     };
 
@@ -2,6 +2,7 @@
 #include "logger.h"
 #include "config.h"
 #include "gui_server.h"
+#include "thread_utils.h"
 
 using namespace fx::network;
 using namespace std::chrono_literals;
@@ -65,6 +66,7 @@ bool gui_server::add_context(gui_context_ptr context_ptr)
 void gui_server::server_thread()
 {
     DEBUG_REQUIRE(!!sock_ptr_);
+    apply_thread_settings(get_thread_settings("gui_server"));
 
     while (!shutdown_)
     {
@@ -95,6 +97,8 @@ void gui_server::server_thread()
 
 void gui_server::cleanup_thread()
 {
+    apply_thread_settings(get_thread_settings("gui_cleanup"));
+
     while (!shutdown_)
     {
         abort_event_.wait();
@@ -166,7 +170,7 @@ bool gui_server::on_tick(symbol sym, const tick_data& tick)
     return add_count > 0;
 }
 
-bool gui_server::on_order(order_cptr optr, order_action action)
+bool gui_server::on_order(const order_snapshot& order, order_action action)
 {
     //DEBUG_TRACE("gui_server::on_order()");
     int add_count = 0;
@@ -181,7 +185,7 @@ bool gui_server::on_order(order_cptr optr, order_action action)
             {
                 if (!p->is_aborted())
                 {
-                    if (p->add_order(optr, action))
+                    if (p->add_order(order, action))
                     {
                         add_count++;
                     }
@@ -190,7 +194,7 @@ bool gui_server::on_order(order_cptr optr, order_action action)
         }
     }
 
-    save_order(optr, action);
+    save_order(order, action);
     return add_count > 0;
 }
 
@@ -223,22 +227,22 @@ std::string gui_server::get_info(symbol sym)
     return (it != info_.end()) ? it->second : "";
 }
 
-void gui_server::save_order(order_cptr optr, order_action action)
+void gui_server::save_order(const order_snapshot& order, order_action action)
 {
-    //DEBUG_TRACE("ID=%ld (%d)", optr->get_id(), action);
+    //DEBUG_TRACE("ID=%ld (%d)", order.id, action);
     std::lock_guard<std::mutex> lock(orders_lock_);
 
-    symbol sym = optr->get_symbol();
+    symbol sym = order.sym;
     auto it = orders_.find(sym);
 
     if (it != orders_.end())
     {
         auto& v = it->second;
-        v.push_back({ optr, action });
+        v.push_back({ order, action });
     }
     else
     {
-        std::vector<order_info> v = {{ optr, action }};
+        std::vector<order_info> v = {{ order, action }};
         orders_.insert({ sym, v });
     }
 }
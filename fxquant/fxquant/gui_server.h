@@ -17,7 +17,7 @@ namespace fx {
 class gui_server // singleton
 {
 public:
-    typedef std::pair<order_cptr, order_action> order_info;
+    typedef std::pair<order_snapshot, order_action> order_info;
 
     struct options
     {
@@ -39,7 +39,7 @@ public:
 
     bool on_tick(symbol sym, const tick_data& tick);
     bool on_bar(symbol sym, timeframe_type tf, const bar_data& bar);
-    bool on_order(order_cptr optr, order_action action);
+    bool on_order(const order_snapshot& order, order_action action);
     bool on_info(symbol sym, const std::string& xml);
 
     void get_orders(symbol sym, std::vector<order_info>& orders);
@@ -62,7 +62,7 @@ private:
         abort_event_.signal();
     }
 
-    void save_order(order_cptr optr, order_action action);
+    void save_order(const order_snapshot& order, order_action action);
     void save_info(symbol sym, const std::string& info_xml);
 
 private:
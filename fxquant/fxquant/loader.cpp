@@ -1,11 +1,20 @@
+#include <chrono>
 #include <string>
+#include <stdexcept>
 #include <fstream>
 #include <sstream>
 #include <iostream>
 
 #include "debug.h"
+#include "utils.h"
 #include "config.h"
+#include "symbol.h"
 #include "mongodb.h"
+#include "tick_store.h"
+#include "ctrl_handler.h"
+#include "shared_memory.h"
+#include "db_bucket_source.h"
+#include "tick_source_factory.h"
 #include "program_options.h"
 
 namespace fx {
@@ -15,12 +24,90 @@ static void print_usage(const std::string& program_name)
     std::cout << "USAGE:\n";
     std::cout << program_name << "\n";
     std::cout << "  -c <config_file> - path to the configuration file (required)\n";
+    std::cout << "  -m               - move the ticks of the 'migration' config section range\n";
+    std::cout << "                     into the one minute bucket collection and exit\n";
+    std::cout << "  -p               - publish the ticks of the 'shared_ticks' config section range\n";
+    std::cout << "                     in shared memory for the other processes until Ctrl+C\n";
     std::cout << "  -h               - print help message and exit\n";
 }
 
+// reads the symbol and the time range of the config section
+static void read_range(const std::string& section, symbol& sym, timepoint_type& from, timepoint_type& to)
+{
+    sym = symbol_from_string(config::get_string(section, "symbol"));
+
+    if (sym == symbol::undefined)
+    {
+        throw std::runtime_error("Symbol is undefined.");
+    }
+
+    from = std::chrono::system_clock::from_time_t(utc_time(
+        config::get_int(section, "start_day"),
+        config::get_int(section, "start_month"),
+        config::get_int(section, "start_year")));
+
+    to = from + std::chrono::hours(24 * config::get_int(section, "calculate_days"));
+}
+
+static bool migrate()
+{
+    try
+    {
+        symbol sym;
+        timepoint_type from;
+        timepoint_type to;
+        read_range("migration", sym, from, to);
+
+        return migrate_ticks_to_buckets(sym, from, to);
+    }
+    catch (const std::exception& x)
+    {
+        std::cerr << "ERROR: " << x.what() << "\n";
+    }
+
+    return false;
+}
+
+static bool publish()
+{
+    try
+    {
+        symbol sym;
+        timepoint_type from;
+        timepoint_type to;
+        read_range("shared_ticks", sym, from, to);
+
+        const std::string name = shared_segment_name("shared_ticks", sym);
+        auto source_ptr = create_tick_source("shared_ticks", sym, from, to);
+        shared_memory shm;
+
+        if (!tick_file::publish(shm, name, sym, from, to, *source_ptr))
+        {
+            std::cerr << "ERROR: shared memory segment could not be created: '" << name << "'\n";
+            return false;
+        }
+
+        std::cout << "Ticks are published in '" << name << "' (" << (shm.size() >> 20) << "MB"
+            << (shm.huge_pages() ? ", huge pages" : "") << "), press Ctrl+C to remove them\n";
+
+        ctrl_handler handler;
+        handler.wait();
+
+        shm.close();
+        shared_memory::remove(name);
+        return true;
+    }
+    catch (const std::exception& x)
+    {
+        std::cerr << "ERROR: " << x.what() << "\n";
+    }
+
+    return false;
+}
+
 int loader(int& argc, char* argv[])
 {
-    program_options po("c:h");
+    program_options po("c:hmp");
 
     if (!po.parse(argc, argv))
     {
@@ -49,6 +136,17 @@ int loader(int& argc, char* argv[])
         std::cout << "ERROR: database server is not accessible!";
         return 3;
     }
+
+    if (po.has_option('m'))
+    {
+        return migrate() ? -1 : 5;
+    }
+
+    if (po.has_option('p'))
+    {
+        return publish() ? -1 : 6;
+    }
+
     return 0;
 }
 } // end of namespace fx
@@ -2,6 +2,8 @@
 
 namespace fx {
 
+// returns 0 to continue, a negative value if the program has done its job
+// and should exit without error, or the error code
 int loader(int& argc, char* argv[]);
 
 }//end of namespace fx
@@ -2,6 +2,7 @@
 #include <string>
 #include <sstream>
 #include <iostream>
+#include <stdexcept>
 
 #include "csv.h"
 #include "logger.h"
@@ -29,6 +30,8 @@ using namespace std::placeholders;
 // 2 - config file could not be read.
 // 3 - can not connect to MongoDB
 // 4 - cought thrown error
+// 5 - tick migration failed
+// 6 - ticks could not be published in shared memory
 
 namespace {
 std::set<strategy_ptr> optim_set;
@@ -36,6 +39,14 @@ std::set<strategy_ptr> optim_set;
 void on_start(strategy_ptr strategy, dummy_feeder_ptr feeder_ptr)
 {
     feeder_ptr->wait_for_stop();
+
+    if (feeder_ptr->has_failed())
+    {
+        // the stats of a partial replay would look like a complete run;
+        // the feeder thread is joined before the optimizer is left
+        feeder_ptr->stop();
+        throw std::runtime_error("The replay failed, see the log.");
+    }
 }
 
 void on_stop(strategy_ptr strategy)
@@ -52,6 +63,7 @@ int main(int argc, char* argv[])
     ctrl_handler handler;
     int err = loader(argc, argv);
     if (err > 0) { return err; }
+    if (err < 0) { return 0; }
 
     gui_server::instance();
 
@@ -64,9 +76,15 @@ int main(int argc, char* argv[])
 
         auto strategy_ptr = std::make_shared<ladder_strategy>();
 
+        // "inline" handles the events on the feeder thread, "shared" on the executor
+        // workers, "queued" (default) on the engine threads
+        const std::string dispatch = config::instance().read_string("engine", "dispatch", "queued");
+        const dispatch_mode mode = (dispatch == "inline") ? dispatch_mode::inline_dispatch :
+            (dispatch == "shared") ? dispatch_mode::shared : dispatch_mode::queued;
+
         engine_ptr eptr = std::make_shared<fx_engine>(
             feeder_ptr, strategy_ptr, dcb_ptr,
-            std::make_shared<dummy_order_callback>());
+            std::make_shared<dummy_order_callback>(), mode);
 
         engine_registry::instance().add_engine(eptr);
 
@@ -74,8 +92,15 @@ int main(int argc, char* argv[])
         feeder_ptr->wait_for_stop();
         feeder_ptr->stop();
 
+        if (feeder_ptr->has_failed())
+        {
+            // the stats of a partial replay would look like a complete run
+            throw std::runtime_error("The replay failed, see the log.");
+        }
+
         eptr->calc_closed_trades_stats();
         eptr->calc_open_trades_stats();
+        eptr->log_queue_stats();
 
         strategy_ptr->print_simple_report();
 
@@ -0,0 +1,118 @@
+#include <chrono>
+#include <vector>
+#include "debug.h"
+#include "utils.h"
+#include "config.h"
+#include "logger.h"
+#include "thread_utils.h"
+#include "mmap_feeder.h"
+#include "db_tick_source.h"
+
+using namespace std::chrono;
+
+namespace fx {
+
+mmap_feeder::mmap_feeder() :
+    data_feeder(symbol_from_string(config::get_string("mmap_feeder", "symbol")))
+    , day_(config::get_int("mmap_feeder", "start_day"))
+    , month_(config::get_int("mmap_feeder", "start_month"))
+    , year_(config::get_int("mmap_feeder", "start_year"))
+    , days_(config::get_int("mmap_feeder", "calculate_days"))
+    , store_(config::instance().read_string("mmap_feeder", "tick_store_dir", "store"))
+    , running_(false), failed_(false)
+{
+    if (get_symbol() == symbol::undefined)
+    {
+        throw std::runtime_error("Symbol is undefined.");
+    }
+}
+
+void mmap_feeder::run()
+{
+    DEBUG_ASSERT(source_ptr_);
+    apply_thread_settings(get_thread_settings("feeder"));
+
+    try
+    {
+        std::vector<tick_data> block(tick_block_size);
+        size_t n;
+
+        // the ticks are read straight from the mapped files in blocks,
+        // nothing is allocated per tick
+        while (running_ && ((n = source_ptr_->next_block(block.data(), block.size())) > 0))
+        {
+            on_ticks(block.data(), n);
+        }
+    }
+    catch (const std::exception& x)
+    {
+        logger::instance().error(std::string("The replay stopped: ") + x.what());
+        failed_ = true;
+    }
+    catch (...)
+    {
+        logger::instance().error("The replay stopped: unknown exception");
+        failed_ = true;
+    }
+
+    stop_event_.signal();
+}
+
+bool mmap_feeder::start()
+{
+    if (running_)
+    {
+        return false; // already started
+    }
+
+    try
+    {
+        if (!source_ptr_)
+        {
+            auto from_time = system_clock::from_time_t(utc_time(day_, month_, year_));
+            auto to_time = from_time + hours(24 * days_);
+
+            if (!fill_tick_store(store_, get_symbol(), from_time, to_time))
+            {
+                return false;
+            }
+
+            source_ptr_ = std::make_unique<tick_store_source>(store_, get_symbol(), from_time, to_time);
+            logger::instance().info("Tick store opened.");
+        }
+        else
+        {
+            source_ptr_->reset();
+        }
+
+        failed_ = false;
+        running_ = true;
+        thread_ptr_ = std::make_unique<std::thread>(std::bind(&mmap_feeder::run, this));
+
+        return true;
+    }
+    catch (const std::exception& x)
+    {
+        DEBUG_TRACE("mmap_feeder::start(): %s", x.what());
+    }
+    catch (...)
+    {
+        DEBUG_TRACE("mmap_feeder::start(): unknown exception");
+    }
+
+    return false;
+}
+
+bool mmap_feeder::stop()
+{
+    if (!running_)
+    {
+        return false; // not started
+    }
+
+    running_ = false;
+    thread_ptr_->join();
+    return true;
+}
+
+} // namespace fx
@@ -0,0 +1,53 @@
+#pragma once
+#include <atomic>
+#include <thread>
+#include <memory>
+#include "event.h"
+#include "symbol.h"
+#include "tick_store.h"
+#include "data_feeder.h"
+
+namespace fx {
+
+// replays the ticks of selected days from the memory-mapped tick store,
+// the days missing in the store are loaded from DB first
+class mmap_feeder : public data_feeder
+{
+public:
+    mmap_feeder();
+
+    virtual bool start() override;
+    virtual bool stop() override;
+
+    void wait_for_stop() const
+    {
+        stop_event_.wait();
+    }
+
+    // true if the replay was stopped by an error rather than by the end of data
+    bool has_failed() const
+    {
+        return failed_;
+    }
+
+private:
+    void run();
+
+private:
+    const int day_;
+    const int month_;
+    const int year_;
+    const int days_;
+    const tick_store store_;
+
+    bool running_;
+    std::atomic_bool failed_;
+    std::unique_ptr<std::thread> thread_ptr_;
+    std::unique_ptr<tick_store_source> source_ptr_;
+
+    mutable event stop_event_;
+};
+
+typedef std::shared_ptr<mmap_feeder> mmap_feeder_ptr;
+
+} // namespace fx
@@ -22,7 +22,9 @@ bool optimizer::run()
             break; // done
         }
 
-        engine_ptr eptr = std::make_shared<fx_engine>(df_ptr_, sptr);
+        // every run is a backtest, the events are handled on the feeder thread
+        engine_ptr eptr = std::make_shared<fx_engine>(df_ptr_, sptr, nullptr, nullptr,
+            dispatch_mode::inline_dispatch);
 
         df_ptr_->start();
 
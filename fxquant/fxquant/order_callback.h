@@ -7,14 +7,14 @@ namespace fx {
 class fx_engine; // forward declaration
 
 // order callback functions are called from the strategy object
-// when order status is changed
+// when order status is changed, with a snapshot of the order
 struct order_callback
 {
-    virtual void on_order_submitted(fx_engine& eng, order_cptr order_ptr) = 0;
-    virtual void on_order_opened(fx_engine& eng, order_cptr order_ptr) = 0;
-    virtual void on_order_closed(fx_engine& eng, order_cptr order_ptr) = 0;
-    virtual void on_order_modified(fx_engine& eng, order_cptr order_ptr) = 0;
-    virtual void on_order_deleted(fx_engine& eng, order_cptr order_ptr) = 0;
+    virtual void on_order_submitted(fx_engine& eng, const order_snapshot& order) = 0;
+    virtual void on_order_opened(fx_engine& eng, const order_snapshot& order) = 0;
+    virtual void on_order_closed(fx_engine& eng, const order_snapshot& order) = 0;
+    virtual void on_order_modified(fx_engine& eng, const order_snapshot& order) = 0;
+    virtual void on_order_deleted(fx_engine& eng, const order_snapshot& order) = 0;
     virtual ~order_callback() = default;
 };
 
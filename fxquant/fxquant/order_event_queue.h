@@ -9,146 +9,98 @@ namespace fx {
 
 class fx_engine; // forward declaration
 
-class base_order_event : public base_event
+// an order snapshot and what has happened to it, both held inline
+struct order_event
 {
-public:
-    base_order_event(fx_engine& eng, order_cptr optr, order_callback_ptr cb_ptr) :
-        engine_(eng), order_ptr_(optr), callback_ptr_(cb_ptr)
-    {
-    }
-
-protected:
-    fx_engine& engine_;
-    order_cptr order_ptr_;
-    order_callback_ptr callback_ptr_;
-};
-
-struct order_submitted_event : public base_order_event
-{
-    order_submitted_event(fx_engine& eng, order_cptr optr, order_callback_ptr cb_ptr) :
-        base_order_event(eng, optr, cb_ptr)
-    {
-    }
+    order_action action;
+    order_snapshot order;
 
-    void operator ()() override
+    order_event() : action(order_action::undefined)
     {
-        gui_server::instance().on_order(order_ptr_, order_action::submitted);
-
-        if (callback_ptr_)
-        {
-            callback_ptr_->on_order_submitted(engine_, order_ptr_);
-        }
     }
-};
 
-struct order_opened_event : public base_order_event
-{
-    order_opened_event(fx_engine& eng, order_cptr optr, order_callback_ptr cb_ptr) :
-        base_order_event(eng, optr, cb_ptr)
+    order_event(order_action a, const base_order& o) : action(a), order(o)
     {
     }
 
-    void operator ()() override
+    bool is_conflatable() const
     {
-        gui_server::instance().on_order(order_ptr_, order_action::opened);
-
-        if (callback_ptr_)
-        {
-            callback_ptr_->on_order_opened(engine_, order_ptr_);
-        }
+        return false;
     }
 };
 
-struct order_closed_event : public base_order_event
+class order_event_queue : public event_queue<order_event>
 {
-    order_closed_event(fx_engine& eng, order_cptr optr, order_callback_ptr cb_ptr) :
-        base_order_event(eng, optr, cb_ptr)
-    {
-    }
-
-    void operator ()() override
-    {
-        gui_server::instance().on_order(order_ptr_, order_action::closed);
-
-        if (callback_ptr_)
-        {
-            callback_ptr_->on_order_closed(engine_, order_ptr_);
-        }
-    }
-};
-
-struct order_deleted_event : public base_order_event
-{
-    order_deleted_event(fx_engine& eng, order_cptr optr, order_callback_ptr cb_ptr) :
-        base_order_event(eng, optr, cb_ptr)
-    {
-    }
-
-    void operator ()() override
-    {
-        gui_server::instance().on_order(order_ptr_, order_action::deleted);
-
-        if (callback_ptr_)
-        {
-            callback_ptr_->on_order_deleted(engine_, order_ptr_);
-        }
-    }
-};
+public:
+    // the order events are rare next to the ticks, a small ring is enough
+    static const size_t default_order_capacity = 256;
 
-struct order_modified_event : public base_order_event
-{
-    order_modified_event(fx_engine& eng, order_cptr optr, order_callback_ptr cb_ptr) :
-        base_order_event(eng, optr, cb_ptr)
+    order_event_queue(fx_engine& eng, order_callback_ptr ocb_ptr, dispatch_mode mode = dispatch_mode::queued,
+        size_t capacity = default_order_capacity, const thread_settings& settings = thread_settings()) :
+        event_queue(mode, capacity, overflow_policy::block, settings),
+        engine_(eng), ocb_ptr_(ocb_ptr)
     {
     }
 
-    void operator ()() override
+    ~order_event_queue()
     {
-        gui_server::instance().on_order(order_ptr_, order_action::modified);
-
-        if (callback_ptr_)
-        {
-            callback_ptr_->on_order_modified(engine_, order_ptr_);
-        }
+        stop();
+        DEBUG_TRACE("~order_event_queue()");
     }
-};
 
-class order_event_queue : public event_queue
-{
-public:
-    order_event_queue(fx_engine& eng, order_callback_ptr ocb_ptr, size_t nthreads = 1) :
-        engine_(eng), event_queue(nthreads), ocb_ptr_(ocb_ptr)
+    bool push_order_submitted_event(const order_cptr& optr)
     {
+        return push_event(order_event(order_action::submitted, *optr));
     }
 
-    ~order_event_queue()
+    bool push_order_opened_event(const order_cptr& optr)
     {
-        DEBUG_TRACE("~order_event_queue()");
+        return push_event(order_event(order_action::opened, *optr));
     }
 
-    bool push_order_submitted_event(order_cptr optr)
+    bool push_order_closed_event(const order_cptr& optr)
     {
-        return push_event(std::make_shared<order_submitted_event>(engine_, optr->clone(), ocb_ptr_));
+        return push_event(order_event(order_action::closed, *optr));
     }
 
-    bool push_order_opened_event(order_cptr optr)
+    bool push_order_modified_event(const order_cptr& optr)
     {
-        return push_event(std::make_shared<order_opened_event>(engine_, optr->clone(), ocb_ptr_));
+        return push_event(order_event(order_action::modified, *optr));
     }
 
-    bool push_order_closed_event(order_cptr optr)
+    bool push_order_deleted_event(const order_cptr& optr)
     {
-        return push_event(std::make_shared<order_closed_event>(engine_, optr->clone(), ocb_ptr_));
+        return push_event(order_event(order_action::deleted, *optr));
     }
 
-    bool push_order_modified_event(order_cptr optr)
+private:
+    void execute(order_event& e) override
     {
-        return push_event(std::make_shared<order_modified_event>(engine_, optr->clone(), ocb_ptr_));
-    }
+        gui_server::instance().on_order(e.order, e.action);
 
-    bool push_order_deleted_event(order_cptr optr)
-    {
-        return push_event(std::make_shared<order_deleted_event>(engine_, optr->clone(), ocb_ptr_));
+        if (ocb_ptr_)
+        {
+            switch (e.action)
+            {
+            case order_action::submitted:
+                ocb_ptr_->on_order_submitted(engine_, e.order);
+                break;
+            case order_action::opened:
+                ocb_ptr_->on_order_opened(engine_, e.order);
+                break;
+            case order_action::closed:
+                ocb_ptr_->on_order_closed(engine_, e.order);
+                break;
+            case order_action::modified:
+                ocb_ptr_->on_order_modified(engine_, e.order);
+                break;
+            case order_action::deleted:
+                ocb_ptr_->on_order_deleted(engine_, e.order);
+                break;
+            default:
+                break;
+            }
+        }
     }
 
 private:
@@ -0,0 +1,137 @@
+#include "debug.h"
+#include "order_index.h"
+
+namespace fx {
+
+namespace {
+const unsigned initial_bits = 6; // 64 slots
+}
+
+order_index::order_index() :
+    slots_(size_t(1) << initial_bits), mask_((size_t(1) << initial_bits) - 1),
+    shift_(64 - initial_bits), size_(0)
+{
+}
+
+size_t order_index::find_slot(order_id_type id) const
+{
+    // the table is never full, so an empty slot ends the probing
+    size_t i = home(id);
+
+    while ((slots_[i].id != 0) && (slots_[i].id != id))
+    {
+        i = (i + 1) & mask_;
+    }
+
+    return i;
+}
+
+bool order_index::insert(order_ptr optr)
+{
+    DEBUG_REQUIRE(optr);
+    DEBUG_REQUIRE(optr->get_id() != 0);
+
+    // keep the load factor at 1/2 at most
+    if ((size_ + 1) * 2 > slots_.size())
+    {
+        grow();
+    }
+
+    slot& s = slots_[find_slot(optr->get_id())];
+
+    if (s.id != 0)
+    {
+        return false; // the id is taken
+    }
+
+    s.id = optr->get_id();
+    s.e = entry();
+    s.e.optr = std::move(optr);
+    size_++;
+    return true;
+}
+
+order_ptr order_index::find(order_id_type id) const
+{
+    if (id == 0)
+    {
+        return nullptr;
+    }
+
+    return slots_[find_slot(id)].e.optr;
+}
+
+order_index::entry* order_index::find_entry(const order_ptr& optr)
+{
+    if (!optr || (optr->get_id() == 0))
+    {
+        return nullptr;
+    }
+
+    slot& s = slots_[find_slot(optr->get_id())];
+
+    // another order may have been indexed under the same id
+    return (s.e.optr == optr) ? &s.e : nullptr;
+}
+
+order_ptr order_index::erase(order_id_type id)
+{
+    if (id == 0)
+    {
+        return nullptr;
+    }
+
+    size_t i = find_slot(id);
+
+    if (slots_[i].id == 0)
+    {
+        return nullptr;
+    }
+
+    order_ptr optr = std::move(slots_[i].e.optr);
+    slots_[i].id = 0;
+    size_--;
+
+    // shift back the entries which probed past the freed slot
+    for (size_t j = (i + 1) & mask_; slots_[j].id != 0; j = (j + 1) & mask_)
+    {
+        const size_t h = home(slots_[j].id);
+
+        // move the entry unless its home is cyclically within (i, j]
+        if (((j - h) & mask_) >= ((j - i) & mask_))
+        {
+            slots_[i] = std::move(slots_[j]);
+            slots_[j].id = 0;
+            slots_[j].e = entry();
+            i = j;
+        }
+    }
+
+    return optr;
+}
+
+void order_index::grow()
+{
+    std::vector<slot> old(slots_.size() * 2);
+    old.swap(slots_);
+    mask_ = slots_.size() - 1;
+    shift_--;
+
+    for (auto& s : old)
+    {
+        if (s.id != 0)
+        {
+            slots_[find_slot(s.id)] = std::move(s);
+        }
+    }
+}
+
+void order_index::clear()
+{
+    slots_.assign(size_t(1) << initial_bits, slot());
+    mask_ = slots_.size() - 1;
+    shift_ = 64 - initial_bits;
+    size_ = 0;
+}
+
+} // namespace fx
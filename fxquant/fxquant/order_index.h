@@ -0,0 +1,79 @@
+#pragma once
+#include <list>
+#include <vector>
+#include "order.h"
+
+namespace fx {
+
+// The orders of an engine by id: an open addressing hash table with linear
+// probing, O(1) lookup, insertion and removal. The removal shifts the following
+// entries back, so there are no tombstones and the lookups stay short. The ids
+// are never 0 (see base_order), 0 marks an empty slot. Next to every order
+// the engine keeps its position in the opened or closed orders, so an order is
+// moved between the lists or deleted without a search.
+class order_index
+{
+public:
+    typedef std::list<order_ptr> order_list;
+
+    // the list which holds an order
+    enum class place { none, opened, closed };
+
+    struct entry
+    {
+        order_ptr optr;
+        place where = place::none;
+        order_list::iterator pos; // valid unless 'where' is none
+    };
+
+    order_index();
+
+    // adds the order, false if an order with the same id is already there
+    bool insert(order_ptr optr);
+
+    // the order with the id, nullptr if there is no such order
+    order_ptr find(order_id_type id) const;
+
+    // the entry of the order, nullptr if the index has no such order;
+    // valid until the next insert() or erase()
+    entry* find_entry(const order_ptr& optr);
+
+    // removes the order with the id, nullptr if there is no such order
+    order_ptr erase(order_id_type id);
+
+    void clear();
+
+    size_t size() const
+    {
+        return size_;
+    }
+
+    bool empty() const
+    {
+        return size_ == 0;
+    }
+
+private:
+    struct slot
+    {
+        order_id_type id = 0; // 0 if the slot is empty
+        entry e;
+    };
+
+    size_t home(order_id_type id) const
+    {
+        // Fibonacci hashing, the sequential ids are spread over the table
+        return static_cast<size_t>((static_cast<uint64_t>(id) * 0x9E3779B97F4A7C15ull) >> shift_);
+    }
+
+    size_t find_slot(order_id_type id) const;
+    void grow();
+
+private:
+    std::vector<slot> slots_; // the size is a power of 2
+    size_t mask_;
+    unsigned shift_;
+    size_t size_;
+};
+
+} // namespace fx
@@ -0,0 +1,164 @@
+#include <vector>
+#include <algorithm>
+#include "debug.h"
+#include "utils.h"
+#include "pending_order_book.h"
+
+namespace fx {
+
+pending_order_book::pending_order_book() : seq_(0), size_(0)
+{
+}
+
+pending_order_book::side_id pending_order_book::get_side(const order_ptr& optr)
+{
+    if (derived_from<buy_limit_order>(optr))
+    {
+        return buy_limit;
+    }
+
+    if (derived_from<buy_stop_order>(optr))
+    {
+        return buy_stop;
+    }
+
+    if (derived_from<sell_limit_order>(optr))
+    {
+        return sell_limit;
+    }
+
+    if (derived_from<sell_stop_order>(optr))
+    {
+        return sell_stop;
+    }
+
+    return side_count; // market or unknown
+}
+
+int64_t pending_order_book::threshold(side_id side, const tick_data& tick)
+{
+    // the buy orders open at the ask price, the sell orders at the bid price
+    const price_type price = ((side == buy_limit) || (side == buy_stop)) ?
+        tick.get_ask_price() : tick.get_bid_price();
+    return to_key(side, price);
+}
+
+void pending_order_book::add(order_ptr optr)
+{
+    DEBUG_REQUIRE(optr);
+
+    const entry e = { seq_++, optr };
+    const side_id side = get_side(optr);
+
+    if ((side == side_count) || optr->get_order_price_value().is_undefined())
+    {
+        others_.push_back(e);
+    }
+    else
+    {
+        sides_[side].insert({ to_key(side, optr->get_order_price_value()), e });
+    }
+
+    size_++;
+}
+
+bool pending_order_book::remove(const order_ptr& optr)
+{
+    DEBUG_REQUIRE(optr);
+
+    const side_id side = get_side(optr);
+
+    if ((side != side_count) && !optr->get_order_price_value().is_undefined())
+    {
+        // only the orders at the same price are looked through
+        auto& s = sides_[side];
+        auto range = s.equal_range(to_key(side, optr->get_order_price_value()));
+
+        for (auto it = range.first; it != range.second; ++it)
+        {
+            if (it->second.optr == optr)
+            {
+                s.erase(it);
+                size_--;
+                return true;
+            }
+        }
+
+        return false;
+    }
+
+    for (auto it = others_.begin(); it != others_.end(); ++it)
+    {
+        if (it->optr == optr)
+        {
+            others_.erase(it);
+            size_--;
+            return true;
+        }
+    }
+
+    return false;
+}
+
+void pending_order_book::take_triggered(const tick_data& tick, order_list& triggered)
+{
+    std::vector<entry> v;
+
+    for (size_t i = 0; i < side_count; ++i)
+    {
+        auto& side = sides_[i];
+
+        if (side.empty() || (side.begin()->first > threshold(side_id(i), tick)))
+        {
+            continue; // the common case, nothing is triggered
+        }
+
+        auto end = side.upper_bound(threshold(side_id(i), tick));
+
+        for (auto it = side.begin(); it != end; ++it)
+        {
+            v.push_back(it->second);
+        }
+
+        side.erase(side.begin(), end);
+    }
+
+    for (auto it = others_.begin(); it != others_.end(); )
+    {
+        if (it->optr->check_open(tick))
+        {
+            v.push_back(*it);
+            it = others_.erase(it);
+        }
+        else
+        {
+            ++it;
+        }
+    }
+
+    if (v.size() > 1)
+    {
+        std::sort(v.begin(), v.end(), [](const entry& a, const entry& b) { return a.seq < b.seq; });
+    }
+
+    for (auto& e : v)
+    {
+        DEBUG_ASSERT(e.optr->check_open(tick));
+        triggered.push_back(e.optr);
+    }
+
+    size_ -= v.size();
+}
+
+void pending_order_book::clear()
+{
+    for (auto& side : sides_)
+    {
+        side.clear();
+    }
+
+    others_.clear();
+    size_ = 0;
+}
+
+} // namespace fx
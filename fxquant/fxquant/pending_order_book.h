@@ -0,0 +1,94 @@
+#pragma once
+#include <map>
+#include <list>
+#include <array>
+#include "order.h"
+
+namespace fx {
+
+// The pending orders of an engine. The limit and stop orders are kept in four
+// sides sorted by the order price so that the order which triggers first is at
+// the front; a tick only touches the orders it triggers, O(log n + k). The
+// market orders, and the orders of any other type, are checked on every tick.
+// The triggered orders are taken in the order they were added.
+class pending_order_book
+{
+public:
+    typedef std::list<order_ptr> order_list;
+
+    pending_order_book();
+
+    void add(order_ptr optr);
+
+    // removes the order, O(log n) for the limit and stop orders;
+    // false if the order is not in the book
+    bool remove(const order_ptr& optr);
+
+    // takes the orders which can be opened at the tick
+    void take_triggered(const tick_data& tick, order_list& triggered);
+
+    void clear();
+
+    size_t size() const
+    {
+        return size_;
+    }
+
+    bool empty() const
+    {
+        return size_ == 0;
+    }
+
+    // calls f(order_ptr) for every order, in no particular order
+    template <typename F>
+    void for_each(F f) const
+    {
+        for (const auto& e : others_)
+        {
+            f(e.optr);
+        }
+
+        for (const auto& side : sides_)
+        {
+            for (const auto& kv : side)
+            {
+                f(kv.second.optr);
+            }
+        }
+    }
+
+private:
+    struct entry
+    {
+        uint64_t seq; // the order of adding
+        order_ptr optr;
+    };
+
+    enum side_id { buy_limit, buy_stop, sell_limit, sell_stop, side_count };
+
+    // the key is the raw order price, negated for the sides which trigger
+    // from the highest price down, so every side triggers from the front:
+    // the orders with key <= threshold(tick) are triggered
+    typedef std::multimap<int64_t, entry> side_type;
+
+    static bool is_descending(side_id side)
+    {
+        return (side == buy_limit) || (side == sell_stop);
+    }
+
+    static int64_t to_key(side_id side, price_type price)
+    {
+        return is_descending(side) ? -price.raw() : price.raw();
+    }
+
+    static int64_t threshold(side_id side, const tick_data& tick);
+    static side_id get_side(const order_ptr& optr);
+
+private:
+    std::array<side_type, side_count> sides_;
+    std::list<entry> others_;
+    uint64_t seq_;
+    size_t size_;
+};
+
+} // namespace fx
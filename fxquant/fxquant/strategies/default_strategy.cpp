@@ -11,44 +11,20 @@ void default_strategy::on_tick(const tick_data& tick)
 {
     DEBUG_REQUIRE(!!engine_ptr_);
 
-    // handle the 'ready to open' orders
-    fx_engine::order_list opening_orders;
-
-    // extract_opening_orders
-    auto it = std::stable_partition(get_pending_orders().begin(), get_pending_orders().end(),
-        [&tick](order_ptr optr) { return !optr->check_open(tick); });
-    opening_orders.insert(opening_orders.end(), std::make_move_iterator(it),
-        std::make_move_iterator(get_pending_orders().end()));
-    get_pending_orders().erase(it, get_pending_orders().end());
-
-    for (auto optr : opening_orders)
-    {
-        if (optr->open(tick)) // open the order
-        {
-            // move order to the list of opened orders
-            get_opened_orders().push_back(optr);
-
-            // inform the engine that the order was opened 
-            get_event_queue().push_order_opened_event(optr);
-        }
-    }
+    // the triggered pending orders have been opened by the engine
 
     // handle the 'ready to close' orders
     fx_engine::order_list closing_orders;
 
     // extract_closing_orders
-    it = std::stable_partition(get_opened_orders().begin(), get_opened_orders().end(),
-        [&tick](order_ptr optr) { return !optr->check_close(tick); });
-    closing_orders.insert(closing_orders.end(), std::make_move_iterator(it),
-        std::make_move_iterator(get_opened_orders().end()));
-    get_opened_orders().erase(it, get_opened_orders().end());
+    take_closing_orders(tick, closing_orders);
 
     for (auto optr : closing_orders)
     {
         if (optr->close(tick))
         {
             // move order to the list of closed orders
-            get_closed_orders().push_back(optr);
+            add_closed_order(optr);
 
             // inform the engine that the order was closed
             get_event_queue().push_order_closed_event(optr);
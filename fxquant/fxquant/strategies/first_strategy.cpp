@@ -70,25 +70,23 @@ bool first_strategy::check_orders_closing(const tick_data& tick)
     fx_engine::order_list closing_orders;
 
     // extract_closing_orders
-    auto it = std::stable_partition(get_opened_orders().begin(), get_opened_orders().end(),
-        [&tick](order_ptr optr) { return !optr->check_close(tick); });
-    closing_orders.insert(closing_orders.end(), std::make_move_iterator(it),
-        std::make_move_iterator(get_opened_orders().end()));
-    get_opened_orders().erase(it, get_opened_orders().end());
+    take_closing_orders(tick, closing_orders);
+
+    bool closed = false;
 
     for (auto optr : closing_orders)
     {
         if (optr->close(tick))
         {
             // move order to the list of closed orders
-            get_closed_orders().push_back(optr);
+            add_closed_order(optr);
 
             // inform the engine that the order was closed
             get_event_queue().push_order_closed_event(optr);
-            return true;
+            closed = true;
         }
     }
-    return false;
+    return closed;
 }
 void first_strategy::on_bar(timeframe_type tf, const bar_data& bar)
 {
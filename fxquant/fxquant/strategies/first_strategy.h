@@ -61,7 +61,7 @@ private:
                 (engine_ptr_->get_symbol(), params_.volume
                     , open_price, sl, tp);
             optr->open(tick);
-            get_opened_orders().push_back(optr);
+            add_opened_order(optr);
         }
         catch (const std::exception&)
         {
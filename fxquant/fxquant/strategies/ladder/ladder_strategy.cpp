@@ -23,7 +23,7 @@ namespace fx {
 ALWAYS_INLINE bool on_level(order_ptr optr, double lvl)
 {
     ladder_strategy::custom_data& cd = static_cast<ladder_strategy::custom_data&>(*(optr->get_custom_data()));
-    return ((int)(cd.nearest_lvl * 10000) == (int)(lvl * 10000));
+    return cd.nearest_lvl == price_type(lvl);
 }
 
 bool compare_profits(const order_ptr& a, const order_ptr& b)
@@ -590,11 +590,9 @@ bool ladder_strategy::check_orders_closing(const tick_data& tick)
     fx_engine::order_list closing_orders;
 
     // extract_closing_orders
-    auto it = std::stable_partition(get_opened_orders().begin(), get_opened_orders().end(),
-        [&tick](order_ptr optr) { return !optr->check_close(tick); });
-    closing_orders.insert(closing_orders.end(), std::make_move_iterator(it),
-        std::make_move_iterator(get_opened_orders().end()));
-    get_opened_orders().erase(it, get_opened_orders().end());
+    take_closing_orders(tick, closing_orders);
+
+    bool closed = false;
 
     for (auto optr : closing_orders)
     {
@@ -602,14 +600,14 @@ bool ladder_strategy::check_orders_closing(const tick_data& tick)
         {
             cycle_profit_ += optr->get_profit();
             // move order to the list of closed orders
-            get_closed_orders().push_back(optr);
+            add_closed_order(optr);
 
             // inform the engine that the order was closed
             get_event_queue().push_order_closed_event(optr);
-            return true;
+            closed = true;
         }
     }
-    return false;
+    return closed;
 }
 
 void ladder_strategy::on_bar(timeframe_type tf, const bar_data& bar)
@@ -756,12 +754,15 @@ void ladder_strategy_compute::set_nearest_level(const tick_data& tick)
     DEBUG_REQUIRE(mid_price_ > 0);
     DEBUG_REQUIRE(strategy_.point_ > 0);
     DEBUG_REQUIRE(strategy_.params_.step > 0);
-    int distance = static_cast<int>(mid_price_ / strategy_.point_) % strategy_.params_.step;
+    // the level is taken on the step grid in whole points, so the same level
+    // always gives the same price_type, whatever the fraction of the mid price
+    const int64_t points = static_cast<int64_t>(mid_price_ / strategy_.point_);
+    int distance = static_cast<int>(points % strategy_.params_.step);
     if (distance > strategy_.params_.step / 2)
     {
-        nearest_level_ = mid_price_ - (distance + strategy_.params_.step) * strategy_.point_;
+        nearest_level_ = strategy_.normalize((points - distance - strategy_.params_.step) * strategy_.point_);
     }
-    nearest_level_ = (mid_price_ - distance*strategy_.point_);
+    nearest_level_ = strategy_.normalize((points - distance) * strategy_.point_);
     DEBUG_ENSURE(nearest_level_ > 0);
 }
 
@@ -187,7 +187,7 @@ private:
             }
 
             optr->open(tick);
-            get_opened_orders().push_back(optr);
+            add_opened_order(optr);
 
             get_event_queue().push_order_opened_event(optr);
         }
@@ -219,7 +219,7 @@ public:
             nearest_lvl(near_lvl),
             computed_profit(0)
         {}
-        double nearest_lvl;
+        price_type nearest_lvl;
         double computed_profit;
     };
 
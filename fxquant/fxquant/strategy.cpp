@@ -170,45 +170,12 @@ bool operator <(strategy_ptr a, strategy_ptr b)
 
 bool strategy::close_trade(const tick_data& tick, order_ptr close_optr)
 {
-    auto it = get_opened_orders().begin();
-    while (it != get_opened_orders().end())
-    {
-        auto optr = *it;
-        if (optr == close_optr)
-        {
-            if (optr->close(tick))
-            {
-                // move order to the list of closed orders
-                get_closed_orders().push_back(optr);
-
-                // remove from open orders
-                get_opened_orders().erase(it);
-
-                // inform the engine that the order was closed
-                get_event_queue().push_order_closed_event(optr);
-
-                return true;
-            }
-        }
-        ++it;
-    }
-    return false;
+    return engine_ptr_->close_opened_order(tick, close_optr);
 }
 
 void strategy::close_all_trades(const tick_data& tick)
 {
-    for (auto optr : get_opened_orders())
-    {
-        if (optr->close(tick))
-        {
-            // move order to the list of closed orders
-            get_closed_orders().push_back(optr);
-
-            // inform the engine that the order was closed
-            get_event_queue().push_order_closed_event(optr);
-        }
-    }
-    get_opened_orders().clear();
+    engine_ptr_->close_opened_orders(tick);
 }
 
 }//namespace fx
\ No newline at end of file
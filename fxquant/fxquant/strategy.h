@@ -77,7 +77,8 @@ public:
     }
 
 protected:
-    fx_engine::order_list& get_pending_orders()
+    // the engine opens the triggered pending orders before on_tick()
+    pending_order_book& get_pending_orders()
     {
         return engine_ptr_->pending_orders_;
     }
@@ -107,6 +108,29 @@ protected:
         return engine_ptr_->order_events_;
     }
 
+    // the opened and closed orders are added through the engine, which keeps
+    // the position of every order in the lists; the lists may be reordered
+    // but not changed otherwise
+
+    // adds an order opened by the strategy to the opened orders
+    void add_opened_order(order_ptr optr)
+    {
+        engine_ptr_->add_opened_order(optr);
+    }
+
+    // adds an order closed by the strategy to the closed orders
+    void add_closed_order(order_ptr optr)
+    {
+        engine_ptr_->add_closed_order(optr);
+    }
+
+    // takes the opened orders whose stop loss or take profit is hit by the tick
+    // out of the opened orders; only the hit levels are touched
+    void take_closing_orders(const tick_data& tick, fx_engine::order_list& closing)
+    {
+        engine_ptr_->take_closing_orders(tick, closing);
+    }
+
     bool close_trade(const tick_data& tick, order_ptr close_optr);
 
     void close_all_trades(const tick_data& tick);
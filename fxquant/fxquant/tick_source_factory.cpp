@@ -0,0 +1,74 @@
+#include <stdexcept>
+#include "config.h"
+#include "tick_store.h"
+#include "tick_archive.h"
+#include "db_tick_source.h"
+#include "db_bucket_source.h"
+#include "tick_source_factory.h"
+
+namespace fx {
+
+tick_source_ptr create_tick_source(const std::string& section, symbol sym,
+    timepoint_type from, timepoint_type to)
+{
+    const std::string source = config::instance().read_string(section, "source", "mongodb");
+
+    if (source == "mongodb")
+    {
+        const int nthreads = config::instance().read_int(section, "fetch_threads", 1);
+        const int chunk_hours = config::instance().read_int(section, "chunk_hours", 24);
+        const int batch_size = config::instance().read_int(section, "batch_size", 0);
+
+        if ((nthreads > 1) && (chunk_hours > 0))
+        {
+            return std::make_shared<chunked_db_tick_source>(sym, from, to,
+                static_cast<size_t>(nthreads), std::chrono::hours(chunk_hours), batch_size);
+        }
+
+        return std::make_shared<db_tick_source>(sym, from, to, batch_size);
+    }
+
+    if (source == "mongodb_buckets")
+    {
+        const int batch_size = config::instance().read_int(section, "batch_size", 0);
+        return std::make_shared<db_bucket_source>(sym, from, to, batch_size);
+    }
+
+    if (source == "shared_memory")
+    {
+        return std::make_shared<shared_tick_source>(shared_segment_name(section, sym), from, to);
+    }
+
+    if (source == "tick_store")
+    {
+        tick_store store(config::instance().read_string(section, "tick_store_dir", "store"));
+
+        if (!fill_tick_store(store, sym, from, to))
+        {
+            throw std::runtime_error("Failed to fill the tick store.");
+        }
+
+        return std::make_shared<tick_store_source>(store, sym, from, to);
+    }
+
+    if (source == "tick_archive")
+    {
+        tick_archive archive(config::instance().read_string(section, "tick_archive_dir", "archive"));
+
+        if (!fill_tick_archive(archive, sym, from, to))
+        {
+            throw std::runtime_error("Failed to fill the tick archive.");
+        }
+
+        return std::make_shared<tick_archive_source>(archive, sym, from, to);
+    }
+
+    throw std::runtime_error("Unknown tick source: " + source);
+}
+
+std::string shared_segment_name(const std::string& section, symbol sym)
+{
+    return config::instance().read_string(section, "segment", "fxquant_" + symbol_to_string(sym));
+}
+
+} // namespace fx
@@ -0,0 +1,25 @@
+#pragma once
+#include <string>
+#include "types.h"
+#include "symbol.h"
+#include "tick_source.h"
+
+namespace fx {
+
+// Creates the tick source selected by the "source" parameter of the config
+// section: "mongodb" (default), "mongodb_buckets", "shared_memory", "tick_store"
+// or "tick_archive". "mongodb_buckets" reads the one minute bucket collections,
+// "shared_memory" attaches to the ticks published by another process. The tick
+// store and the compressed tick archive are filled from DB on demand, their
+// locations are set by the "tick_store_dir" and "tick_archive_dir" parameters.
+// With "fetch_threads" > 1 the DB range is split into "chunk_hours" long
+// chunks which are fetched in parallel. "batch_size" sets the number of
+// documents returned by the server per round trip, 0 keeps the driver default.
+tick_source_ptr create_tick_source(const std::string& section, symbol sym,
+    timepoint_type from, timepoint_type to);
+
+// the name of the shared memory segment with the ticks of the symbol,
+// set by the "segment" parameter of the config section
+std::string shared_segment_name(const std::string& section, symbol sym);
+
+} // namespace fx